@@ -1,4 +1,4 @@
-QT       += core gui serialport qml widgets quick quickwidgets
+QT       += core gui network serialport qml widgets quick quickwidgets
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -12,17 +12,71 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     serialhandler.cpp \
+    replaysource.cpp \
+    sensortablemodel.cpp \
+    sensorregistry.cpp \
+    sensorhistory.cpp \
+    trendwidget.cpp \
+    spectrumanalyzer.cpp \
+    spectrumworker.cpp \
+    spectrumview.cpp \
+    framereassembler.cpp \
+    framedecoder.cpp \
+    framescan.cpp \
+    acquisitionworker.cpp \
+    acquisitionpool.cpp \
+    latestvaluesegment.cpp \
+    alarmengine.cpp \
+    runstatistics.cpp \
+    telemetrypacket.cpp \
+    telemetrypublisher.cpp \
+    binarylog.cpp \
+    compressedlog.cpp \
+    timeseriescodec.cpp \
+    csvlog.cpp \
+    logwriter.cpp \
+    latencyhistogram.cpp \
     qcgaugewidget.cpp
 
 HEADERS += \
     mainwindow.h \
     serialhandler.h \
+    replaysource.h \
+    sensortablemodel.h \
+    sensorregistry.h \
+    sensorhistory.h \
+    trendwidget.h \
+    spectrumanalyzer.h \
+    spectrumworker.h \
+    spectrumview.h \
+    framereassembler.h \
+    framedecoder.h \
+    framescan.h \
+    spscqueue.h \
+    acquisitionworker.h \
+    acquisitionpool.h \
+    latestvaluesegment.h \
+    emsshm.h \
+    alarmengine.h \
+    runstatistics.h \
+    telemetrypacket.h \
+    telemetrypublisher.h \
+    monotonicclock.h \
+    binarylog.h \
+    compressedlog.h \
+    timeseriescodec.h \
+    csvlog.h \
+    logwriter.h \
+    latencyhistogram.h \
     qcgaugewidget.h
 
 
 FORMS += \
     mainwindow.ui
 
+# shm_open() of the latest-value segment
+linux: LIBS += -lrt
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
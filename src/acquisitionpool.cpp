@@ -0,0 +1,79 @@
+#include "acquisitionpool.h"
+
+AcquisitionPool::AcquisitionPool(LatencyStats *stats) : latency(stats) {
+    logThread.start();
+}
+
+AcquisitionPool::~AcquisitionPool() {
+    closeAll();
+    for (const Source &source : sources) {
+        source.thread->quit();
+        source.thread->wait();
+        delete source.thread;
+    }
+    stopLogs();
+    logThread.quit();
+    logThread.wait();
+}
+
+int AcquisitionPool::addSource() {
+    if (sources.size() >= MaxSources)
+        return -1;
+
+    const int index = sources.size();
+    Source source;
+    source.thread = new QThread;
+    source.worker = new AcquisitionWorker;
+    source.logWriter = new LogWriter;
+    source.started = false;
+
+    // Source 0 keeps the plain log names
+    if (index > 0)
+        source.logWriter->setFileSuffix(QString("_port%1").arg(index + 1));
+    source.logWriter->setLatencyStats(latency);
+    source.logWriter->moveToThread(&logThread);
+    QObject::connect(&logThread, &QThread::finished, source.logWriter, &QObject::deleteLater);
+
+    source.worker->setSourceId(quint8(index));
+#ifdef Q_OS_UNIX
+    source.worker->openLatestValues(LatestValueSegment::defaultName(quint8(index)));
+#endif
+    source.worker->setLogQueue(&source.logWriter->queue());
+    source.worker->setAlarmLogQueue(&source.logWriter->alarmQueue());
+    source.worker->setLatencyStats(latency);
+    source.worker->moveToThread(source.thread);
+    QObject::connect(source.thread, &QThread::finished, source.worker, &QObject::deleteLater);
+
+    sources.append(source);
+    return index;
+}
+
+void AcquisitionPool::start() {
+    for (Source &source : sources) {
+        if (!source.started) {
+            source.thread->start(QThread::TimeCriticalPriority);
+            source.started = true;
+        }
+    }
+}
+
+void AcquisitionPool::closeAll() {
+    for (const Source &source : sources) {
+        if (!source.thread->isRunning())
+            continue;
+        AcquisitionWorker *worker = source.worker;
+        QMetaObject::invokeMethod(worker, [worker]() {
+            worker->closeSerialPort();
+            worker->closeReplay();
+        }, Qt::BlockingQueuedConnection);
+    }
+}
+
+void AcquisitionPool::stopLogs() {
+    if (!logThread.isRunning())
+        return;
+    for (const Source &source : sources) {
+        LogWriter *logWriter = source.logWriter;
+        QMetaObject::invokeMethod(logWriter, [logWriter]() { logWriter->stop(); }, Qt::BlockingQueuedConnection);
+    }
+}
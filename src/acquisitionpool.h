@@ -0,0 +1,52 @@
+#ifndef ACQUISITIONPOOL_H
+#define ACQUISITIONPOOL_H
+
+#include <QThread>
+#include <QVector>
+#include "acquisitionworker.h"
+#include "logwriter.h"
+
+// The serial sources of a test cell. Every source has its own acquisition
+// thread (reader, reassembler, decoder, alarms, statistics) and its own
+// LogWriter, so a slow or noisy port never holds up another; the log
+// writers share one thread. Frames carry their source index and are stamped
+// on the common monotonic clock, so data from all sources lines up in time.
+// Sensor IDs are namespaced by source: the same ID on two ports is two
+// channels.
+class AcquisitionPool {
+public:
+    static const int MaxSources = 8;
+
+    explicit AcquisitionPool(LatencyStats *latency = nullptr);
+    ~AcquisitionPool();
+
+    // Creates the next source, returns its index or -1 when all are in use.
+    // Configure its worker, then call start().
+    int addSource();
+    // Starts the threads of the sources added since the last call
+    void start();
+
+    int sourceCount() const { return sources.size(); }
+    AcquisitionWorker *worker(int source) const { return sources[source].worker; }
+    LogWriter *logWriter(int source) const { return sources[source].logWriter; }
+
+    // Blocking; close the ports and replays of every source / stop every log
+    void closeAll();
+    void stopLogs();
+
+private:
+    Q_DISABLE_COPY(AcquisitionPool)
+
+    struct Source {
+        QThread *thread;
+        AcquisitionWorker *worker;
+        LogWriter *logWriter;
+        bool started;
+    };
+
+    QVector<Source> sources;
+    QThread logThread;
+    LatencyStats *latency;
+};
+
+#endif // ACQUISITIONPOOL_H
@@ -0,0 +1,122 @@
+#include "acquisitionworker.h"
+#include "monotonicclock.h"
+#include "sensorregistry.h"
+#include <QDebug>
+
+AcquisitionWorker::AcquisitionWorker(QObject *parent)
+    : QObject(parent), serialHandler(new SerialHandler(this)), replaySource(new ReplaySource(this)), logQueue(nullptr), latency(nullptr), alarmLogQueue(nullptr), spectrumQueue(nullptr), telemetryQueue(nullptr), dropped(0), droppedLog(0), droppedTelemetry(0), msgCounter(0), sourceId(0), spectrumId(0) {
+    connect(serialHandler, &SerialHandler::frameReceived, this, &AcquisitionWorker::handleFrame, Qt::DirectConnection);
+    connect(replaySource, &ReplaySource::frameReceived, this, &AcquisitionWorker::handleFrame, Qt::DirectConnection);
+    alarms.configure(sensorRegistry());
+    statistics.setChannels(sensorRegistry().valueIds());
+}
+
+bool AcquisitionWorker::openSerialPort(const QString &portName, qint32 baudRate,
+                                       QSerialPort::Parity parity,
+                                       QSerialPort::StopBits stopBits) {
+    replaySource->close();
+    msgCounter = 0;
+    alarms.reset();
+    statistics.clear();
+    return serialHandler->openSerialPort(portName, baudRate, parity, stopBits);
+}
+
+void AcquisitionWorker::setDisplayQueueEnabled(bool enabled) {
+    if (!enabled)
+        frames.reset();
+    else if (!frames)
+        frames.reset(new DecodedFrameQueue);
+}
+
+bool AcquisitionWorker::openLatestValues(const QString &name) {
+    if (latestValues.open(name, sourceId, sensorRegistry()))
+        return true;
+    qWarning() << "Cannot publish latest values to" << name << latestValues.errorString();
+    return false;
+}
+
+void AcquisitionWorker::closeSerialPort() {
+    serialHandler->closeSerialPort();
+}
+
+bool AcquisitionWorker::openReplay(const QString &fileName) {
+    serialHandler->closeSerialPort();
+    msgCounter = 0;
+    alarms.reset();
+    statistics.clear();
+    return replaySource->open(fileName);
+}
+
+void AcquisitionWorker::closeReplay() {
+    replaySource->close();
+}
+
+void AcquisitionWorker::seekReplay(qint64 record) {
+    // The first frame after the jump may repeat the last counter seen
+    msgCounter = 0;
+    replaySource->seek(record);
+}
+
+void AcquisitionWorker::handleFrame(const quint8 *frame, int size, qint64 arrivalNs) {
+    if (!decodeFrame(frame, size, decoded))
+        return;
+
+    // The device repeats a frame until its counter moves on
+    if (decoded.counter == msgCounter)
+        return;
+    msgCounter = decoded.counter;
+    decoded.source = sourceId;
+    decoded.arrivalNs = arrivalNs;
+    decoded.decodedNs = monotonicNanoseconds();
+    if (latency)
+        latency->arrivalToDecoded.record(decoded.decodedNs - arrivalNs);
+
+    // Alarms and statistics are updated here, before the frame is queued for
+    // anyone
+    AlarmEvent event;
+    bool alarmChanged = false;
+    for (int i = 0; i < decoded.sensorCount; ++i) {
+        const SensorSample &sample = decoded.samples[i];
+        if (alarms.evaluate(sample.id, arrivalNs, float(sample.value), event)) {
+            publishAlarm(event);
+            alarmChanged = true;
+        }
+        statistics.add(sample.id, sample.value);
+        if (sample.id == spectrumId && spectrumQueue)
+            spectrumQueue->push({ arrivalNs, float(sample.value) });
+    }
+    if (alarmChanged)
+        emit alarmsChanged();
+
+    // Local readers see the frame before any queue consumer does
+    latestValues.write(decoded);
+
+    if (frames && !frames->push(decoded))
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    if (logQueue && !logQueue->push(decoded))
+        droppedLog.fetch_add(1, std::memory_order_relaxed);
+    if (telemetryQueue && !telemetryQueue->push(decoded))
+        droppedTelemetry.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AcquisitionWorker::publishAlarm(const AlarmEvent &event) {
+    // Alarm events are rare; a full queue means nobody is draining it
+    if (frames)
+        alarmEvents.push(event);
+    if (alarmLogQueue)
+        alarmLogQueue->push(event);
+}
+
+void AcquisitionWorker::acknowledgeAlarm(quint8 id) {
+    const qint64 now = monotonicNanoseconds();
+    AlarmEvent event;
+    bool changed = false;
+    for (int sensor = 1; sensor < SensorIdCount; ++sensor) {
+        if ((id == 0 || sensor == id) && alarms.acknowledge(quint8(sensor), now, event)) {
+            publishAlarm(event);
+            changed = true;
+        }
+    }
+    if (changed)
+        emit alarmsChanged();
+}
@@ -0,0 +1,111 @@
+#ifndef ACQUISITIONWORKER_H
+#define ACQUISITIONWORKER_H
+
+#include <QObject>
+#include <atomic>
+#include <memory>
+#include "serialhandler.h"
+#include "replaysource.h"
+#include "spscqueue.h"
+#include "framedecoder.h"
+#include "latencyhistogram.h"
+#include "alarmengine.h"
+#include "spectrumworker.h"
+#include "runstatistics.h"
+#include "telemetrypublisher.h"
+#include "latestvaluesegment.h"
+
+typedef SpscQueue<DecodedFrame, 4096> DecodedFrameQueue;
+
+// Reads and decodes frames on its own thread. The GUI never sees serial
+// signals; it drains decoded frames from queue() at its own pace.
+class AcquisitionWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit AcquisitionWorker(QObject *parent = nullptr);
+
+    // Stamped on every frame and statistic. Set before the thread starts.
+    void setSourceId(quint8 id) { sourceId = id; }
+    quint8 source() const { return sourceId; }
+
+    // Must be called on the worker's thread
+    bool openSerialPort(const QString &portName, qint32 baudRate,
+                        QSerialPort::Parity parity, QSerialPort::StopBits stopBits);
+    void closeSerialPort();
+
+    // Plays a binary log through the same decode path instead of the port.
+    // Control playback through replay(), on the worker's thread; seek with
+    // seekReplay(), which also forgets the last frame counter.
+    bool openReplay(const QString &fileName);
+    void closeReplay();
+    void seekReplay(qint64 record);
+    ReplaySource *replay() { return replaySource; }
+
+    // Only while the display queue is enabled
+    DecodedFrameQueue &queue() { return *frames; }
+    // Off unless something drains queue(), i.e. a GUI; the queue is only
+    // allocated while on. Set before the thread starts.
+    void setDisplayQueueEnabled(bool enabled);
+    quint64 droppedFrames() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Every decoded frame is also pushed here. Set before the thread starts.
+    void setLogQueue(DecodedFrameQueue *queue) { logQueue = queue; }
+    quint64 droppedLogFrames() const { return droppedLog.load(std::memory_order_relaxed); }
+
+    void setLatencyStats(LatencyStats *stats) { latency = stats; }
+
+    // Alarm events for the GUI, drained on alarmsChanged(); only filled while
+    // the display queue is enabled
+    AlarmEventQueue &alarmQueue() { return alarmEvents; }
+    // Every alarm event is also pushed here. Set before the thread starts.
+    void setAlarmLogQueue(AlarmEventQueue *queue) { alarmLogQueue = queue; }
+    // Samples of sensor id are also pushed here. Set before the thread starts.
+    void setSpectrumQueue(TimedSampleQueue *queue, quint8 id) { spectrumQueue = queue; spectrumId = id; }
+    // Decoded frames are also pushed here while set; null stops publishing.
+    // Set while no port or replay is open.
+    void setTelemetryQueue(TelemetryFrameQueue *queue) { telemetryQueue = queue; }
+    quint64 droppedTelemetryFrames() const { return droppedTelemetry.load(std::memory_order_relaxed); }
+
+    // Publishes the newest sample of every sensor into the shared memory
+    // object name (see emsshm.h). Call before the thread starts.
+    bool openLatestValues(const QString &name);
+
+    // Statistics of every value sensor since the port or replay was opened.
+    // Must be called on the worker's thread.
+    QVector<SensorStatistics> statisticsSummary() const { return statistics.summary(sourceId); }
+
+    // Must be called on the worker's thread; id 0 acknowledges every alarm
+    void acknowledgeAlarm(quint8 id);
+
+signals:
+    // Emitted from the worker's thread right after the frame that changed an alarm
+    void alarmsChanged();
+
+private slots:
+    void handleFrame(const quint8 *frame, int size, qint64 arrivalNs);
+
+private:
+    void publishAlarm(const AlarmEvent &event);
+
+    SerialHandler *serialHandler;
+    ReplaySource *replaySource;
+    std::unique_ptr<DecodedFrameQueue> frames;
+    DecodedFrameQueue *logQueue;
+    LatencyStats *latency;
+    DecodedFrame decoded;
+    AlarmEngine alarms;
+    RunStatistics statistics;
+    LatestValueSegment latestValues;
+    AlarmEventQueue alarmEvents;
+    AlarmEventQueue *alarmLogQueue;
+    TimedSampleQueue *spectrumQueue;
+    TelemetryFrameQueue *telemetryQueue;
+    std::atomic<quint64> dropped;
+    std::atomic<quint64> droppedLog;
+    std::atomic<quint64> droppedTelemetry;
+    quint8 msgCounter;
+    quint8 sourceId;
+    quint8 spectrumId;
+};
+
+#endif // ACQUISITIONWORKER_H
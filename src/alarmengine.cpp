@@ -0,0 +1,134 @@
+#include "alarmengine.h"
+#include <cmath>
+
+AlarmEngine::AlarmEngine() {
+    for (State &state : states)
+        state.enabled = false;
+    reset();
+}
+
+void AlarmEngine::configure(const SensorRegistry &registry) {
+    for (int id = 0; id < SensorIdCount; ++id) {
+        states[id].limits = registry.alarmLimits(quint8(id));
+        states[id].enabled = registry[quint8(id)].kind == SensorKind::Value;
+    }
+    reset();
+}
+
+void AlarmEngine::setLimits(quint8 id, const AlarmLimits &limits) {
+    states[id].limits = limits;
+    states[id].enabled = true;
+}
+
+void AlarmEngine::reset() {
+    for (State &state : states) {
+        state.acknowledged = true;
+        state.hasLast = false;
+        state.active = AlarmSeverity::Normal;
+        state.activeCause = AlarmCause::None;
+        state.condition = AlarmSeverity::Normal;
+        state.conditionCause = AlarmCause::None;
+        state.pending = AlarmSeverity::Normal;
+        state.pendingSinceNs = 0;
+        state.lastValue = 0;
+        state.lastTimeNs = 0;
+    }
+}
+
+void AlarmEngine::fill(const State &state, quint8 id, qint64 timeNs, float value, AlarmEvent::Type type, AlarmEvent &event) const {
+    event.timeNs = timeNs;
+    event.value = value;
+    event.id = id;
+    event.band = 0;
+    event.type = type;
+    event.severity = state.active;
+    event.cause = state.activeCause;
+    event.acknowledged = state.acknowledged;
+}
+
+// A limit that is already exceeded only clears hysteresis back inside it
+static bool above(float value, float limit, bool exceeded, float hysteresis) {
+    return value > (exceeded ? limit - hysteresis : limit);
+}
+
+static bool below(float value, float limit, bool exceeded, float hysteresis) {
+    return value < (exceeded ? limit + hysteresis : limit);
+}
+
+bool AlarmEngine::evaluate(quint8 id, qint64 timeNs, float value, AlarmEvent &event) {
+    State &state = states[id];
+    if (!state.enabled)
+        return false;
+    const AlarmLimits &limits = state.limits;
+
+    const bool high = state.conditionCause == AlarmCause::High;
+    const bool low = state.conditionCause == AlarmCause::Low;
+    const bool critical = state.condition == AlarmSeverity::Critical;
+    AlarmSeverity condition = AlarmSeverity::Normal;
+    AlarmCause cause = AlarmCause::None;
+    if (above(value, limits.criticalHigh, high && critical, limits.hysteresis)) {
+        condition = AlarmSeverity::Critical;
+        cause = AlarmCause::High;
+    } else if (below(value, limits.criticalLow, low && critical, limits.hysteresis)) {
+        condition = AlarmSeverity::Critical;
+        cause = AlarmCause::Low;
+    } else if (above(value, limits.warningHigh, high, limits.hysteresis)) {
+        condition = AlarmSeverity::Warning;
+        cause = AlarmCause::High;
+    } else if (below(value, limits.warningLow, low, limits.hysteresis)) {
+        condition = AlarmSeverity::Warning;
+        cause = AlarmCause::Low;
+    }
+
+    if (limits.maxRate > 0 && state.hasLast && timeNs > state.lastTimeNs) {
+        const float rate = std::fabs(value - state.lastValue) * 1e9f / float(timeNs - state.lastTimeNs);
+        if (rate > limits.maxRate && condition == AlarmSeverity::Normal) {
+            condition = AlarmSeverity::Warning;
+            cause = AlarmCause::Rate;
+        }
+    }
+    state.hasLast = true;
+    state.lastValue = value;
+    state.lastTimeNs = timeNs;
+    state.condition = condition;
+    state.conditionCause = cause;
+
+    if (condition > state.active) {
+        // Raised once the condition held for delayMs
+        if (state.pending != condition) {
+            state.pending = condition;
+            state.pendingSinceNs = timeNs;
+        }
+        if (timeNs - state.pendingSinceNs < qint64(limits.delayMs) * 1000000)
+            return false;
+        state.active = condition;
+        state.activeCause = cause;
+        state.acknowledged = false;
+        fill(state, id, timeNs, value, AlarmEvent::Raised, event);
+        return true;
+    }
+
+    state.pending = condition;
+    state.pendingSinceNs = timeNs;
+    if (condition == state.active || (limits.latching && !state.acknowledged))
+        return false;
+    state.active = condition;
+    state.activeCause = cause;
+    fill(state, id, timeNs, value, condition == AlarmSeverity::Normal ? AlarmEvent::Cleared : AlarmEvent::Reduced, event);
+    return true;
+}
+
+bool AlarmEngine::acknowledge(quint8 id, qint64 timeNs, AlarmEvent &event) {
+    State &state = states[id];
+    if (state.active == AlarmSeverity::Normal || state.acknowledged)
+        return false;
+
+    // A latched alarm whose condition went away clears now
+    state.acknowledged = true;
+    if (state.condition < state.active) {
+        state.active = state.condition;
+        state.activeCause = state.conditionCause;
+    }
+    fill(state, id, timeNs, state.lastValue, AlarmEvent::Acknowledged, event);
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef ALARMENGINE_H
+#define ALARMENGINE_H
+
+#include <QtGlobal>
+#include "sensorregistry.h"
+#include "spscqueue.h"
+
+enum class AlarmSeverity : quint8 { Normal, Warning, Critical };
+enum class AlarmCause : quint8 { None, Low, High, Rate };
+
+struct AlarmEvent {
+    enum Type : quint8 { Raised, Reduced, Cleared, Acknowledged };
+
+    qint64 timeNs; // arrival of the frame that caused it, or of the acknowledgement
+    float value;
+    quint8 id;
+    quint8 band; // 1-based spectrum band of sensor id, 0 for the sensor value
+    Type type;
+    AlarmSeverity severity; // after the event
+    AlarmCause cause;
+    bool acknowledged;
+};
+
+typedef SpscQueue<AlarmEvent, 256> AlarmEventQueue;
+
+// Evaluates the AlarmLimits of every value sensor sample by sample, on the
+// acquisition thread. Limits clear with hysteresis, a rate above maxRate is
+// a warning, a condition is only raised once it held for delayMs, and a
+// latching alarm stays raised until acknowledged. All state sits in a flat
+// array indexed by sensor ID; nothing is allocated.
+class AlarmEngine {
+public:
+    AlarmEngine();
+
+    void configure(const SensorRegistry &registry);
+    // Evaluates id against limits instead of the registry's
+    void setLimits(quint8 id, const AlarmLimits &limits);
+    void reset();
+
+    // Returns true and fills event when the alarm state of the sensor changes
+    bool evaluate(quint8 id, qint64 timeNs, float value, AlarmEvent &event);
+    bool acknowledge(quint8 id, qint64 timeNs, AlarmEvent &event);
+
+    AlarmSeverity severity(quint8 id) const { return states[id].active; }
+    bool isAcknowledged(quint8 id) const { return states[id].acknowledged; }
+
+private:
+    struct State {
+        AlarmLimits limits;
+        bool enabled;
+        bool acknowledged;
+        bool hasLast;
+        AlarmSeverity active;    // what is shown
+        AlarmCause activeCause;
+        AlarmSeverity condition; // what the latest sample says
+        AlarmCause conditionCause;
+        AlarmSeverity pending;   // condition waiting out delayMs
+        qint64 pendingSinceNs;
+        float lastValue;
+        qint64 lastTimeNs;
+    };
+
+    void fill(const State &state, quint8 id, qint64 timeNs, float value, AlarmEvent::Type type, AlarmEvent &event) const;
+
+    State states[SensorIdCount];
+};
+
+#endif // ALARMENGINE_H
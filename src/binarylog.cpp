@@ -0,0 +1,224 @@
+#include "binarylog.h"
+#include "monotonicclock.h"
+#include <QDateTime>
+#include <algorithm>
+#include <cstring>
+
+static void copyName(char *dest, int size, const QString &text) {
+    const QByteArray utf8 = text.toUtf8();
+    const int length = qMin(utf8.size(), size - 1);
+    memset(dest, 0, size);
+    memcpy(dest, utf8.constData(), length);
+}
+
+BinaryLogSensorDescriptor binaryLogSensor(quint8 id, quint8 statusId, const QString &name,
+                                          const QString &unit, float minValue, float maxValue) {
+    BinaryLogSensorDescriptor sensor;
+    memset(&sensor, 0, sizeof(sensor));
+    sensor.id = id;
+    sensor.statusId = statusId;
+    sensor.minValue = minValue;
+    sensor.maxValue = maxValue;
+    copyName(sensor.name, sizeof(sensor.name), name);
+    copyName(sensor.unit, sizeof(sensor.unit), unit);
+    return sensor;
+}
+
+QVector<BinaryLogSensorDescriptor> binaryLogSensors(const SensorRegistry &registry) {
+    QVector<BinaryLogSensorDescriptor> sensors;
+    for (quint8 id : registry.valueIds()) {
+        const SensorDescriptor &sensor = registry[id];
+        sensors.append(binaryLogSensor(sensor.id, sensor.pairedId, QString::fromUtf8(sensor.name),
+                                       QString::fromUtf8(sensor.unit), sensor.minValue, sensor.maxValue));
+    }
+    return sensors;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+BinaryLogWriter::BinaryLogWriter() : bufferSize(0), sensorCount(0) {
+}
+
+BinaryLogWriter::~BinaryLogWriter() {
+    close();
+}
+
+bool BinaryLogWriter::open(const QString &fileName, const QVector<BinaryLogSensorDescriptor> &sensors) {
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    sensorCount = sensors.size();
+    std::fill(fieldIndex, fieldIndex + 256, qint16(-1));
+    std::fill(statusIndex, statusIndex + 256, qint16(-1));
+    for (int i = 0; i < sensorCount; ++i) {
+        fieldIndex[sensors[i].id] = qint16(i);
+        if (sensors[i].statusId != 0)
+            statusIndex[sensors[i].statusId] = qint16(i);
+    }
+
+    const int descriptorsEnd = int(sizeof(BinaryLogFileHeader) + sensorCount * sizeof(BinaryLogSensorDescriptor));
+    const int alignment = 64;
+
+    BinaryLogFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BinaryLogMagic, sizeof(header.magic));
+    header.version = BinaryLogVersion;
+    header.headerSize = quint32((descriptorsEnd + alignment - 1) / alignment * alignment);
+    header.recordSize = binaryLogRecordSize(sensorCount);
+    header.sensorCount = quint32(sensorCount);
+    header.startMonotonicNs = monotonicNanoseconds();
+    header.startUtcMs = QDateTime::currentMSecsSinceEpoch();
+
+    QByteArray head(int(header.headerSize), '\0');
+    memcpy(head.data(), &header, sizeof(header));
+    memcpy(head.data() + sizeof(header), sensors.constData(), sensorCount * sizeof(BinaryLogSensorDescriptor));
+    if (file.write(head) != head.size()) {
+        file.close();
+        return false;
+    }
+
+    record.fill('\0', int(header.recordSize));
+    pending.reserve(bufferSize + record.size());
+    return true;
+}
+
+void BinaryLogWriter::close() {
+    if (!file.isOpen())
+        return;
+    flush();
+    file.close();
+}
+
+bool BinaryLogWriter::flush() {
+    if (pending.isEmpty())
+        return true;
+    const bool written = file.write(pending) == pending.size();
+    pending.resize(0); // keeps the reserved capacity
+    return file.flush() && written;
+}
+
+bool BinaryLogWriter::write(const DecodedFrame &frame) {
+    char *data = record.data();
+    BinaryLogRecordHeader *recordHeader = reinterpret_cast<BinaryLogRecordHeader *>(data);
+    BinaryLogField *fields = reinterpret_cast<BinaryLogField *>(data + sizeof(BinaryLogRecordHeader));
+
+    recordHeader->timestampNs = frame.arrivalNs;
+    recordHeader->counter = frame.counter;
+    recordHeader->sensorCount = frame.sensorCount;
+    for (int i = 0; i < sensorCount; ++i) {
+        fields[i].rawValue = 0;
+        fields[i].factor = 0;
+        fields[i].status = 0;
+    }
+
+    for (int i = 0; i < frame.sensorCount; ++i) {
+        const SensorSample &sample = frame.samples[i];
+        const int field = fieldIndex[sample.id];
+        if (field >= 0) {
+            fields[field].rawValue = sample.rawValue;
+            fields[field].factor = sample.factor;
+            fields[field].status |= BinaryLogField::Present;
+            continue;
+        }
+        const int statusField = statusIndex[sample.id];
+        if (statusField >= 0)
+            fields[statusField].status |= sample.rawValue != 0 ? BinaryLogField::StatusPresent | BinaryLogField::Error
+                                                               : BinaryLogField::StatusPresent;
+    }
+
+    if (bufferSize == 0)
+        return file.write(data, record.size()) == record.size();
+
+    pending.append(data, record.size());
+    if (pending.size() < bufferSize)
+        return true;
+    return flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+BinaryLogReader::BinaryLogReader() : base(nullptr), records(0) {
+}
+
+BinaryLogReader::~BinaryLogReader() {
+    close();
+}
+
+bool BinaryLogReader::open(const QString &fileName) {
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(BinaryLogFileHeader))) {
+        error = QStringLiteral("File is too small to be a binary log");
+        file.close();
+        return false;
+    }
+
+    base = file.map(0, size);
+    if (!base) {
+        error = file.errorString();
+        file.close();
+        return false;
+    }
+
+    const BinaryLogFileHeader &head = header();
+    const qint64 descriptorsEnd = qint64(sizeof(BinaryLogFileHeader)) + qint64(head.sensorCount) * sizeof(BinaryLogSensorDescriptor);
+    if (memcmp(head.magic, BinaryLogMagic, sizeof(head.magic)) != 0 || head.version != BinaryLogVersion
+        || head.sensorCount > 256 || head.recordSize != binaryLogRecordSize(int(head.sensorCount))
+        || head.headerSize < descriptorsEnd || head.headerSize > size || head.headerSize % 8 != 0) {
+        error = QStringLiteral("Not a supported binary log");
+        close();
+        return false;
+    }
+
+    // A partially written last record is ignored
+    records = (size - head.headerSize) / head.recordSize;
+    return true;
+}
+
+void BinaryLogReader::close() {
+    if (base)
+        file.unmap(base);
+    base = nullptr;
+    records = 0;
+    if (file.isOpen())
+        file.close();
+}
+
+const BinaryLogFileHeader &BinaryLogReader::header() const {
+    return *reinterpret_cast<const BinaryLogFileHeader *>(base);
+}
+
+const BinaryLogSensorDescriptor &BinaryLogReader::sensor(int index) const {
+    const BinaryLogSensorDescriptor *sensors = reinterpret_cast<const BinaryLogSensorDescriptor *>(base + sizeof(BinaryLogFileHeader));
+    return sensors[index];
+}
+
+int BinaryLogReader::sensorIndex(quint8 id) const {
+    for (int i = 0; i < sensorCount(); ++i) {
+        if (sensor(i).id == id)
+            return i;
+    }
+    return -1;
+}
+
+const uchar *BinaryLogReader::recordAt(qint64 index) const {
+    return base + header().headerSize + index * header().recordSize;
+}
+
+const BinaryLogRecordHeader &BinaryLogReader::record(qint64 index) const {
+    return *reinterpret_cast<const BinaryLogRecordHeader *>(recordAt(index));
+}
+
+const BinaryLogField *BinaryLogReader::fields(qint64 index) const {
+    return reinterpret_cast<const BinaryLogField *>(recordAt(index) + sizeof(BinaryLogRecordHeader));
+}
@@ -0,0 +1,144 @@
+#ifndef BINARYLOG_H
+#define BINARYLOG_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include "framedecoder.h"
+#include "sensorregistry.h"
+
+// Binary run log.
+//
+// File layout (little-endian, every struct naturally aligned):
+//   BinaryLogFileHeader
+//   BinaryLogSensorDescriptor[sensorCount]
+//   padding up to headerSize
+//   records, each BinaryLogRecordHeader + BinaryLogField[sensorCount],
+//   zero padded to a multiple of 8 bytes
+//
+// Every record has the same size, so record n starts at
+// headerSize + n * recordSize and the file can be mapped and indexed
+// directly without parsing. The padding keeps timestampNs of every record
+// 8-byte aligned in the mapping.
+
+static const char BinaryLogMagic[8] = { 'E', 'M', 'S', 'L', 'O', 'G', '\r', '\n' };
+static const quint32 BinaryLogVersion = 2;
+
+struct BinaryLogFileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 headerSize;  // offset of the first record
+    quint32 recordSize;
+    quint32 sensorCount;
+    qint64 startMonotonicNs;
+    qint64 startUtcMs;
+    quint8 reserved[24];
+};
+
+struct BinaryLogSensorDescriptor {
+    quint8 id;
+    quint8 statusId; // ID carrying this sensor's error flag, 0 if none
+    quint8 reserved[2];
+    float minValue;
+    float maxValue;
+    char name[40];
+    char unit[12];
+};
+
+struct BinaryLogRecordHeader {
+    qint64 timestampNs; // monotonic, compare with startMonotonicNs
+    quint8 counter;
+    quint8 sensorCount; // sensors present in the source frame
+    quint8 reserved[6];
+};
+
+struct BinaryLogField {
+    // StatusPresent: the frame carried this sensor's error flag
+    enum Status { Present = 0x01, Error = 0x02, StatusPresent = 0x04 };
+
+    quint32 rawValue;
+    quint32 factor;
+    quint8 status;
+    quint8 reserved[3];
+};
+
+static_assert(sizeof(BinaryLogFileHeader) == 64, "BinaryLogFileHeader layout changed");
+static_assert(sizeof(BinaryLogSensorDescriptor) == 64, "BinaryLogSensorDescriptor layout changed");
+static_assert(sizeof(BinaryLogRecordHeader) == 16, "BinaryLogRecordHeader layout changed");
+static_assert(sizeof(BinaryLogField) == 12, "BinaryLogField layout changed");
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "Binary log is written in host byte order");
+
+inline quint32 binaryLogRecordSize(int sensorCount) {
+    const quint32 size = quint32(sizeof(BinaryLogRecordHeader) + sensorCount * sizeof(BinaryLogField));
+    return (size + 7) & ~quint32(7);
+}
+
+BinaryLogSensorDescriptor binaryLogSensor(quint8 id, quint8 statusId, const QString &name,
+                                          const QString &unit, float minValue, float maxValue);
+
+// Descriptors for every value sensor of the registry, in table order
+QVector<BinaryLogSensorDescriptor> binaryLogSensors(const SensorRegistry &registry);
+
+class BinaryLogWriter {
+public:
+    BinaryLogWriter();
+    ~BinaryLogWriter();
+
+    bool open(const QString &fileName, const QVector<BinaryLogSensorDescriptor> &sensors);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    QString errorString() const { return file.errorString(); }
+
+    // Records are collected in memory and written once this many bytes are
+    // pending; 0 writes every record straight through
+    void setBufferSize(int bytes) { bufferSize = bytes; }
+
+    // Formats the frame into the fixed record and appends it. Sensors the
+    // frame does not carry keep a zero status.
+    bool write(const DecodedFrame &frame);
+    bool flush();
+
+private:
+    Q_DISABLE_COPY(BinaryLogWriter)
+
+    QFile file;
+    QByteArray record;
+    QByteArray pending;
+    int bufferSize;
+    int sensorCount;
+    qint16 fieldIndex[256];  // sensor ID -> field, -1 if not logged
+    qint16 statusIndex[256]; // status ID -> field, -1 if not a status ID
+};
+
+// Read-only view of a binary log mapped into memory
+class BinaryLogReader {
+public:
+    BinaryLogReader();
+    ~BinaryLogReader();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+    QString errorString() const { return error; }
+
+    const BinaryLogFileHeader &header() const;
+    int sensorCount() const { return int(header().sensorCount); }
+    const BinaryLogSensorDescriptor &sensor(int index) const;
+    int sensorIndex(quint8 id) const;
+
+    qint64 recordCount() const { return records; }
+    const BinaryLogRecordHeader &record(qint64 index) const;
+    const BinaryLogField *fields(qint64 index) const;
+
+private:
+    Q_DISABLE_COPY(BinaryLogReader)
+
+    const uchar *recordAt(qint64 index) const;
+
+    QFile file;
+    uchar *base;
+    qint64 records;
+    QString error;
+};
+
+#endif // BINARYLOG_H
@@ -0,0 +1,288 @@
+#include "compressedlog.h"
+#include "monotonicclock.h"
+#include <QDateTime>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+static const int BlockAlignment = 8;
+
+static int paddedSize(int size) {
+    return (size + BlockAlignment - 1) / BlockAlignment * BlockAlignment;
+}
+
+static double scaledValue(double raw, quint32 factor) {
+    return factor == 0 ? raw : raw / factor;
+}
+
+CompressedLogWriter::CompressedLogWriter() : bufferSize(0), fileSize(0) {
+    std::fill(channelIndex, channelIndex + 256, qint16(-1));
+}
+
+CompressedLogWriter::~CompressedLogWriter() {
+    close();
+}
+
+bool CompressedLogWriter::open(const QString &fileName, const QVector<BinaryLogSensorDescriptor> &sensors) {
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    // A channel per value sensor and one per status ID
+    std::fill(channelIndex, channelIndex + 256, qint16(-1));
+    channels.clear();
+    channels.reserve(sensors.size() * 2);
+    for (const BinaryLogSensorDescriptor &sensor : sensors) {
+        const quint8 ids[] = { sensor.id, sensor.statusId };
+        for (quint8 id : ids) {
+            if (id == 0 || channelIndex[id] >= 0)
+                continue;
+            channelIndex[id] = qint16(channels.size());
+            channels.append(Channel());
+            channels.last().id = id;
+            channels.last().factor = 0;
+        }
+    }
+    index.clear();
+
+    const int descriptorsEnd = int(sizeof(CompressedLogFileHeader) + sensors.size() * sizeof(BinaryLogSensorDescriptor));
+    const int alignment = 64;
+
+    CompressedLogFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CompressedLogMagic, sizeof(header.magic));
+    header.version = CompressedLogVersion;
+    header.headerSize = quint32((descriptorsEnd + alignment - 1) / alignment * alignment);
+    header.sensorCount = quint32(sensors.size());
+    header.blockSamples = BlockSamples;
+    header.startMonotonicNs = monotonicNanoseconds();
+    header.startUtcMs = QDateTime::currentMSecsSinceEpoch();
+
+    QByteArray head(int(header.headerSize), '\0');
+    memcpy(head.data(), &header, sizeof(header));
+    memcpy(head.data() + sizeof(header), sensors.constData(), sensors.size() * sizeof(BinaryLogSensorDescriptor));
+    if (file.write(head) != head.size()) {
+        file.close();
+        return false;
+    }
+    fileSize = head.size();
+    pending.reserve(bufferSize + int(sizeof(CompressedLogBlock)) + BlockSamples * TimeSeriesEncoder::MaxBitsPerSample / 8 + BlockAlignment);
+    return true;
+}
+
+void CompressedLogWriter::close() {
+    if (!file.isOpen())
+        return;
+    for (int channel = 0; channel < channels.size(); ++channel)
+        seal(channel);
+
+    // The index goes last; the header learns where it is once it is written
+    const qint64 indexOffset = fileSize;
+    pending.append(reinterpret_cast<const char *>(index.constData()), index.size() * int(sizeof(CompressedLogBlock)));
+    fileSize += index.size() * qint64(sizeof(CompressedLogBlock));
+    if (flush() && file.seek(offsetof(CompressedLogFileHeader, indexOffset))) {
+        const quint32 indexCount = quint32(index.size());
+        file.write(reinterpret_cast<const char *>(&indexOffset), sizeof(indexOffset));
+        file.write(reinterpret_cast<const char *>(&indexCount), sizeof(indexCount));
+    }
+    file.close();
+    index.clear();
+}
+
+bool CompressedLogWriter::flush() {
+    if (pending.isEmpty())
+        return true;
+    const bool written = file.write(pending) == pending.size();
+    pending.resize(0); // keeps the reserved capacity
+    return file.flush() && written;
+}
+
+bool CompressedLogWriter::write(const DecodedFrame &frame) {
+    bool written = true;
+    for (int i = 0; i < frame.sensorCount; ++i) {
+        const SensorSample &sample = frame.samples[i];
+        const int channel = channelIndex[sample.id];
+        if (channel < 0)
+            continue;
+
+        Channel &target = channels[channel];
+        TimeSeriesEncoder &encoder = target.encoder;
+        if (encoder.sampleCount() > 0
+            && (sample.factor != target.factor || frame.arrivalNs - encoder.firstNs() >= MaxBlockSpanNs))
+            written = seal(channel) && written;
+        if (encoder.sampleCount() == 0)
+            target.factor = sample.factor;
+        encoder.append(frame.arrivalNs, double(sample.rawValue));
+        if (encoder.sampleCount() == BlockSamples)
+            written = seal(channel) && written;
+    }
+    return written;
+}
+
+bool CompressedLogWriter::sealExpired(qint64 nowNs) {
+    bool written = true;
+    for (int channel = 0; channel < channels.size(); ++channel) {
+        const TimeSeriesEncoder &encoder = channels[channel].encoder;
+        if (encoder.sampleCount() > 0 && nowNs - encoder.firstNs() >= MaxBlockSpanNs)
+            written = seal(channel) && written;
+    }
+    return written;
+}
+
+bool CompressedLogWriter::seal(int channel) {
+    Channel &source = channels[channel];
+    TimeSeriesEncoder &encoder = source.encoder;
+    if (encoder.sampleCount() == 0)
+        return true;
+
+    const QByteArray &payload = encoder.finish();
+    CompressedLogBlock block;
+    memset(&block, 0, sizeof(block));
+    block.id = source.id;
+    block.sampleCount = quint32(encoder.sampleCount());
+    block.factor = source.factor;
+    block.payloadSize = quint32(payload.size());
+    block.firstNs = encoder.firstNs();
+    block.lastNs = encoder.lastNs();
+    block.offset = fileSize;
+    block.minValue = float(scaledValue(encoder.minimum(), source.factor));
+    block.maxValue = float(scaledValue(encoder.maximum(), source.factor));
+
+    const int size = int(sizeof(block)) + paddedSize(payload.size());
+    pending.append(reinterpret_cast<const char *>(&block), sizeof(block));
+    pending.append(payload);
+    pending.append(QByteArray(paddedSize(payload.size()) - payload.size(), '\0'));
+    fileSize += size;
+    index.append(block);
+    encoder.clear();
+
+    if (pending.size() < bufferSize)
+        return true;
+    return flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+CompressedLogReader::CompressedLogReader() : base(nullptr) {
+}
+
+CompressedLogReader::~CompressedLogReader() {
+    close();
+}
+
+bool CompressedLogReader::open(const QString &fileName) {
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(CompressedLogFileHeader))) {
+        error = QStringLiteral("File is too small to be a compressed log");
+        file.close();
+        return false;
+    }
+
+    base = file.map(0, size);
+    if (!base) {
+        error = file.errorString();
+        file.close();
+        return false;
+    }
+
+    const CompressedLogFileHeader &head = header();
+    const qint64 descriptorsEnd = qint64(sizeof(CompressedLogFileHeader)) + qint64(head.sensorCount) * sizeof(BinaryLogSensorDescriptor);
+    if (memcmp(head.magic, CompressedLogMagic, sizeof(head.magic)) != 0 || head.version != CompressedLogVersion
+        || head.headerSize < descriptorsEnd || head.headerSize > size) {
+        error = QStringLiteral("Not a supported compressed log");
+        close();
+        return false;
+    }
+
+    const qint64 indexEnd = head.indexOffset + qint64(head.indexCount) * sizeof(CompressedLogBlock);
+    if (head.indexOffset >= head.headerSize && indexEnd <= size) {
+        blocks.resize(int(head.indexCount));
+        memcpy(blocks.data(), base + head.indexOffset, head.indexCount * sizeof(CompressedLogBlock));
+        for (const CompressedLogBlock &block : blocks) {
+            if (block.offset < head.headerSize || block.offset + qint64(sizeof(block)) + block.payloadSize > head.indexOffset) {
+                error = QStringLiteral("Damaged block index");
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Not closed: the blocks are self-describing, a partial last one is ignored
+    return scanBlocks(size);
+}
+
+bool CompressedLogReader::scanBlocks(qint64 size) {
+    qint64 position = header().headerSize;
+    while (position + qint64(sizeof(CompressedLogBlock)) <= size) {
+        CompressedLogBlock block;
+        memcpy(&block, base + position, sizeof(block));
+        const qint64 next = position + qint64(sizeof(block)) + paddedSize(int(block.payloadSize));
+        if (block.offset != position || block.sampleCount == 0 || next > size)
+            break;
+        blocks.append(block);
+        position = next;
+    }
+    return true;
+}
+
+void CompressedLogReader::close() {
+    if (base)
+        file.unmap(base);
+    base = nullptr;
+    blocks.clear();
+    if (file.isOpen())
+        file.close();
+}
+
+const CompressedLogFileHeader &CompressedLogReader::header() const {
+    return *reinterpret_cast<const CompressedLogFileHeader *>(base);
+}
+
+const BinaryLogSensorDescriptor &CompressedLogReader::sensor(int index) const {
+    const BinaryLogSensorDescriptor *sensors = reinterpret_cast<const BinaryLogSensorDescriptor *>(base + sizeof(CompressedLogFileHeader));
+    return sensors[index];
+}
+
+bool CompressedLogReader::decodeBlock(int index, QVector<CompressedSample> &samples) const {
+    const CompressedLogBlock &block = blocks[index];
+    TimeSeriesDecoder decoder(base + block.offset + sizeof(CompressedLogBlock), int(block.payloadSize),
+                              int(block.sampleCount), block.firstNs);
+    CompressedSample sample;
+    double raw;
+    quint32 decoded = 0;
+    while (decoder.next(sample.timeNs, raw)) {
+        sample.value = scaledValue(raw, block.factor);
+        samples.append(sample);
+        ++decoded;
+    }
+    return decoded == block.sampleCount;
+}
+
+bool CompressedLogReader::read(quint8 id, qint64 fromNs, qint64 toNs, QVector<CompressedSample> &samples) const {
+    // The blocks of one channel are sealed in time order
+    QVector<CompressedSample> decoded;
+    bool complete = true;
+    for (int i = 0; i < blocks.size(); ++i) {
+        const CompressedLogBlock &block = blocks[i];
+        if (block.id != id || block.lastNs < fromNs - TimeSeriesEncoder::TickNs || block.firstNs > toNs)
+            continue;
+        decoded.resize(0);
+        complete = decodeBlock(i, decoded) && complete;
+        for (const CompressedSample &sample : decoded) {
+            if (sample.timeNs >= fromNs && sample.timeNs <= toNs)
+                samples.append(sample);
+        }
+    }
+    return complete;
+}
@@ -0,0 +1,152 @@
+#ifndef COMPRESSEDLOG_H
+#define COMPRESSEDLOG_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include "binarylog.h"
+#include "framedecoder.h"
+#include "timeseriescodec.h"
+
+// Compressed run log.
+//
+// File layout (little-endian, every struct naturally aligned):
+//   CompressedLogFileHeader
+//   BinaryLogSensorDescriptor[sensorCount]
+//   padding up to headerSize
+//   blocks, each CompressedLogBlock + payload, padded to 8 bytes
+//   CompressedLogBlock[indexCount], the block index
+//
+// Every channel (a value sensor or its status ID) is compressed on its own
+// with TimeSeriesEncoder, over the integer raw values: value = raw / factor
+// as in decodeFrame(). A block holds up to BlockSamples samples of one
+// channel with one factor; it is sealed earlier when the factor changes or
+// its samples span MaxBlockSpanNs. The index at the end lists every block
+// with its time range and value range, so a reader decodes only the blocks
+// of the channels and times it needs. A log that was not closed has no
+// index; the reader then walks the blocks instead.
+
+static const char CompressedLogMagic[8] = { 'E', 'M', 'S', 'Z', 'L', 'O', 'G', '\n' };
+static const quint32 CompressedLogVersion = 1;
+
+struct CompressedLogFileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 headerSize;  // offset of the first block
+    quint32 sensorCount;
+    quint32 blockSamples;
+    qint64 startMonotonicNs;
+    qint64 startUtcMs;
+    qint64 indexOffset;  // 0 while the log is open
+    quint32 indexCount;
+    quint8 reserved[12];
+};
+
+struct CompressedLogBlock {
+    quint8 id;           // channel: sensor or status ID
+    quint8 reserved0[3];
+    quint32 sampleCount;
+    quint32 factor;      // value = raw / factor, raw when 0
+    quint32 payloadSize; // bytes following this header
+    qint64 firstNs;      // monotonic, compare with startMonotonicNs
+    qint64 lastNs;
+    qint64 offset;       // of this header in the file
+    float minValue;
+    float maxValue;
+    quint8 reserved[8];
+};
+
+static_assert(sizeof(CompressedLogFileHeader) == 64, "CompressedLogFileHeader layout changed");
+static_assert(sizeof(CompressedLogBlock) == 56, "CompressedLogBlock layout changed");
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "Compressed log is written in host byte order");
+
+class CompressedLogWriter {
+public:
+    static const int BlockSamples = 1024;
+    static const qint64 MaxBlockSpanNs = 60 * qint64(1000000000);
+
+    CompressedLogWriter();
+    ~CompressedLogWriter();
+
+    bool open(const QString &fileName, const QVector<BinaryLogSensorDescriptor> &sensors);
+    // Seals the open blocks and writes the index
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    QString errorString() const { return file.errorString(); }
+
+    // Sealed blocks are collected in memory and written once this many
+    // bytes are pending; 0 writes every block straight through. Samples of
+    // a block still being filled stay in memory until it is sealed.
+    void setBufferSize(int bytes) { bufferSize = bytes; }
+
+    bool write(const DecodedFrame &frame);
+    bool flush();
+    // Seals the blocks whose first sample is MaxBlockSpanNs or more before
+    // nowNs, also of channels that stopped reporting. Call it periodically.
+    bool sealExpired(qint64 nowNs);
+
+    // Bytes written or pending, for the compression ratio
+    qint64 size() const { return fileSize; }
+
+private:
+    Q_DISABLE_COPY(CompressedLogWriter)
+
+    struct Channel {
+        TimeSeriesEncoder encoder;
+        quint8 id;
+        quint32 factor;
+    };
+
+    bool seal(int channel);
+
+    QFile file;
+    QByteArray pending;
+    QVector<Channel> channels;
+    QVector<CompressedLogBlock> index;
+    qint16 channelIndex[256]; // sensor or status ID -> channel, -1 if not logged
+    int bufferSize;
+    qint64 fileSize;
+};
+
+// timeNs is the arrival time rounded down to TimeSeriesEncoder::TickNs
+struct CompressedSample {
+    qint64 timeNs;
+    double value;
+};
+
+// Read-only view of a compressed log mapped into memory
+class CompressedLogReader {
+public:
+    CompressedLogReader();
+    ~CompressedLogReader();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+    QString errorString() const { return error; }
+
+    const CompressedLogFileHeader &header() const;
+    int sensorCount() const { return int(header().sensorCount); }
+    const BinaryLogSensorDescriptor &sensor(int index) const;
+
+    // In file order, which is the order the blocks were sealed
+    int blockCount() const { return blocks.size(); }
+    const CompressedLogBlock &block(int index) const { return blocks[index]; }
+    bool decodeBlock(int index, QVector<CompressedSample> &samples) const;
+
+    // Samples of channel id with fromNs <= timeNs <= toNs, in time order.
+    // Only the blocks overlapping the range are decoded.
+    bool read(quint8 id, qint64 fromNs, qint64 toNs, QVector<CompressedSample> &samples) const;
+
+private:
+    Q_DISABLE_COPY(CompressedLogReader)
+
+    bool scanBlocks(qint64 size);
+
+    QFile file;
+    uchar *base;
+    QVector<CompressedLogBlock> blocks;
+    QString error;
+};
+
+#endif // COMPRESSEDLOG_H
@@ -0,0 +1,31 @@
+QT = core testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = coretests
+
+# Correctness checks of the monitor's own sources
+INCLUDEPATH += ..
+
+SOURCES += \
+    tst_coretests.cpp \
+    ../binarylog.cpp \
+    ../compressedlog.cpp \
+    ../framedecoder.cpp \
+    ../framereassembler.cpp \
+    ../framescan.cpp \
+    ../runstatistics.cpp \
+    ../sensorregistry.cpp \
+    ../timeseriescodec.cpp
+
+HEADERS += \
+    ../binarylog.h \
+    ../compressedlog.h \
+    ../framedecoder.h \
+    ../framereassembler.h \
+    ../framescan.h \
+    ../monotonicclock.h \
+    ../runstatistics.h \
+    ../sensorregistry.h \
+    ../timeseriescodec.h
@@ -0,0 +1,438 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "binarylog.h"
+#include "compressedlog.h"
+#include "framedecoder.h"
+#include "framereassembler.h"
+#include "framescan.h"
+#include "runstatistics.h"
+#include "sensorregistry.h"
+#include "timeseriescodec.h"
+
+namespace {
+
+// Built by hand the way the baseline parser read the wire: value, factor and
+// checksum are little-endian. Counter 7, two sensors:
+//   0x01  raw 1000  factor 10  -> 100.0
+//   0x05  raw 12345 factor 0   -> 12345
+// checksum 0x016D = sum of the bytes from the counter to the last factor
+const quint8 DeviceFrame[] = {
+    0xA5, 0xA5, 0xA5, 0xA5,
+    0x07, 0x02,
+    0x01, 0x00, 0xE8, 0x03, 0x00, 0x00, 0x0A, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x39, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x6D, 0x01,
+    0x55
+};
+
+struct LoggedSample {
+    quint8 id;
+    qint64 timeNs;
+    double value;
+};
+
+// Decoded times are rounded down to the tick of the block they are in
+bool sameTime(qint64 decodedNs, qint64 timeNs) {
+    return decodedNs <= timeNs && timeNs - decodedNs < TimeSeriesEncoder::TickNs;
+}
+
+} // namespace
+
+class CoreTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void reassembleDeviceFrame();
+    void decodeDeviceFrame();
+    void encodeDeviceFrame();
+    void scanDeviceFrame();
+    void binaryLogRoundTrip();
+    void registryKeepsStatus();
+    void registryRejectsWholeFile();
+    void timeSeriesEdgeCases();
+    void compressedLogRoundTrip();
+    void quantileEstimates();
+    void runStatistics();
+
+private:
+    bool loadRegistry(SensorRegistry &registry, const QByteArray &json);
+
+    QTemporaryDir directory;
+};
+
+void CoreTests::initTestCase() {
+    QVERIFY(directory.isValid());
+}
+
+void CoreTests::reassembleDeviceFrame() {
+    FrameReassembler reassembler;
+    const char garbage[] = { 0x00, char(0xA5), 0x13 };
+    reassembler.append(garbage, sizeof(garbage));
+    reassembler.append(reinterpret_cast<const char *>(DeviceFrame), sizeof(DeviceFrame));
+
+    QCOMPARE(reassembler.nextFrame(), int(sizeof(DeviceFrame)));
+    QVERIFY(memcmp(reassembler.frame(), DeviceFrame, sizeof(DeviceFrame)) == 0);
+    QCOMPARE(reassembler.nextFrame(), 0);
+    QCOMPARE(reassembler.badFrames(), quint64(0));
+}
+
+void CoreTests::decodeDeviceFrame() {
+    DecodedFrame frame;
+    QVERIFY(decodeFrame(DeviceFrame, sizeof(DeviceFrame), frame));
+    QCOMPARE(int(frame.counter), 7);
+    QCOMPARE(int(frame.sensorCount), 2);
+    QCOMPARE(int(frame.samples[0].id), 0x01);
+    QCOMPARE(frame.samples[0].rawValue, quint32(1000));
+    QCOMPARE(frame.samples[0].factor, quint32(10));
+    QCOMPARE(frame.samples[0].value, 100.0);
+    QCOMPARE(int(frame.samples[1].id), 0x05);
+    QCOMPARE(frame.samples[1].rawValue, quint32(12345));
+    QCOMPARE(frame.samples[1].factor, quint32(0));
+    QCOMPARE(frame.samples[1].value, 12345.0);
+}
+
+void CoreTests::encodeDeviceFrame() {
+    DecodedFrame frame;
+    QVERIFY(decodeFrame(DeviceFrame, sizeof(DeviceFrame), frame));
+    quint8 encoded[FrameReassembler::MaxFrameSize];
+    QCOMPARE(encodeFrame(frame, encoded), int(sizeof(DeviceFrame)));
+    QVERIFY(memcmp(encoded, DeviceFrame, sizeof(DeviceFrame)) == 0);
+}
+
+void CoreTests::scanDeviceFrame() {
+    QByteArray stream("\x01\x02", 2);
+    stream.append(reinterpret_cast<const char *>(DeviceFrame), sizeof(DeviceFrame));
+    QByteArray corrupted(reinterpret_cast<const char *>(DeviceFrame), sizeof(DeviceFrame));
+    corrupted[int(sizeof(DeviceFrame)) - 3] ^= 0x01;
+    stream.append(corrupted);
+    stream.append(reinterpret_cast<const char *>(DeviceFrame), sizeof(DeviceFrame));
+
+    QVector<qint64> offsets;
+    scanFrames(reinterpret_cast<const quint8 *>(stream.constData()), stream.size(), offsets);
+    QCOMPARE(offsets.size(), 2);
+    QCOMPARE(offsets[0], qint64(2));
+    QCOMPARE(offsets[1], qint64(2 + 2 * sizeof(DeviceFrame)));
+}
+
+// 15 sensors make 196-byte fields; the padded record keeps timestamps aligned
+void CoreTests::binaryLogRoundTrip() {
+    QVector<BinaryLogSensorDescriptor> sensors;
+    for (int i = 0; i < 15; ++i)
+        sensors.append(binaryLogSensor(quint8(0x01 + i), i == 0 ? 0x11 : 0, QString("S%1").arg(i), "u", 0, 100));
+
+    const QString fileName = directory.filePath("roundtrip.emslog");
+    BinaryLogWriter writer;
+    writer.setBufferSize(1024);
+    QVERIFY(writer.open(fileName, sensors));
+    for (int n = 0; n < 3; ++n) {
+        DecodedFrame frame;
+        frame.arrivalNs = 1000000 * (n + 1);
+        frame.counter = quint8(n + 1);
+        frame.sensorCount = 2;
+        frame.samples[0] = { 0x01, quint32(250 + n), 10, 0 };
+        frame.samples[1] = { 0x11, quint32(n == 1), 0, 0 };
+        QVERIFY(writer.write(frame));
+    }
+    writer.close();
+
+    BinaryLogReader reader;
+    QVERIFY2(reader.open(fileName), qPrintable(reader.errorString()));
+    QCOMPARE(reader.sensorCount(), 15);
+    QCOMPARE(reader.header().recordSize % 8, quint32(0));
+    QCOMPARE(reader.header().recordSize, quint32(200));
+    QCOMPARE(reader.recordCount(), qint64(3));
+    QCOMPARE(QString::fromUtf8(reader.sensor(2).name), QString("S2"));
+    QCOMPARE(reader.sensorIndex(0x0F), 14);
+    for (int n = 0; n < 3; ++n) {
+        const BinaryLogRecordHeader &record = reader.record(n);
+        QCOMPARE(quintptr(&record) % 8, quintptr(0));
+        QCOMPARE(record.timestampNs, qint64(1000000) * (n + 1));
+        QCOMPARE(int(record.counter), n + 1);
+        const BinaryLogField *fields = reader.fields(n);
+        QCOMPARE(fields[0].rawValue, quint32(250 + n));
+        QCOMPARE(fields[0].factor, quint32(10));
+        const int status = BinaryLogField::Present | BinaryLogField::StatusPresent;
+        QCOMPARE(int(fields[0].status), n == 1 ? status | BinaryLogField::Error : status);
+        QCOMPARE(int(fields[1].status), 0);
+    }
+}
+
+bool CoreTests::loadRegistry(SensorRegistry &registry, const QByteArray &json) {
+    QFile file(directory.filePath("sensors.json"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+        return false;
+    file.close();
+    return registry.loadJson(file.fileName());
+}
+
+// An alarm override of EGT must not drop its 0x15 error flag
+void CoreTests::registryKeepsStatus() {
+    SensorRegistry kept;
+    QVERIFY(loadRegistry(kept, R"({"sensors": [{"id": "0x05", "name": "EGT", "min": 0, "max": 400,
+                                  "alarm": {"warningHigh": 320}}]})"));
+    QCOMPARE(int(kept[0x05].pairedId), 0x15);
+    QVERIFY(kept[0x15].kind == SensorKind::Status);
+    QCOMPARE(int(kept[0x15].pairedId), 0x05);
+    QCOMPARE(kept.alarmLimits(0x05).warningHigh, 320.0f);
+
+    SensorRegistry moved;
+    QVERIFY(loadRegistry(moved, R"({"sensors": [{"id": "0x05", "statusId": "0x25"}]})"));
+    QCOMPARE(int(moved[0x05].pairedId), 0x25);
+    QVERIFY(moved[0x25].kind == SensorKind::Status);
+    QVERIFY(moved[0x15].kind == SensorKind::Unused);
+
+    SensorRegistry removed;
+    QVERIFY(loadRegistry(removed, R"({"sensors": [{"id": "0x05", "statusId": "0x00"}]})"));
+    QCOMPARE(int(removed[0x05].pairedId), 0);
+    QVERIFY(removed[0x15].kind == SensorKind::Unused);
+}
+
+// A valid entry followed by an invalid one leaves the registry as it was
+void CoreTests::registryRejectsWholeFile() {
+    SensorRegistry registry;
+    const int rows = registry.rowCount();
+    QVERIFY(!loadRegistry(registry, R"({"sensors": [{"id": "0x05", "statusId": "0x25", "gauge": 0,
+                                        "alarm": {"warningHigh": 320}},
+                                       {"id": "0x30", "statusId": "0x30"}]})"));
+    QCOMPARE(int(registry[0x05].pairedId), 0x15);
+    QCOMPARE(int(registry[0x05].gauge), int(NoGauge));
+    QCOMPARE(int(registry[0x01].gauge), int(OilPressureGauge));
+    QVERIFY(registry[0x15].kind == SensorKind::Status);
+    QVERIFY(registry[0x25].kind == SensorKind::Unused);
+    QVERIFY(registry[0x30].kind == SensorKind::Unused);
+    QVERIFY(qIsInf(registry.alarmLimits(0x05).warningHigh));
+    QCOMPARE(registry.rowCount(), rows);
+
+    QVERIFY(!loadRegistry(registry, R"({"sensors": [{"id": "0x30", "name": "Oil Level"}],
+                                       "spectrum": {"size": 8}})"));
+    QVERIFY(registry[0x30].kind == SensorKind::Unused);
+    QCOMPARE(registry.spectrumSettings().size, 256);
+    QCOMPARE(registry.rowCount(), rows);
+}
+
+// Every delta-of-delta bucket and the special doubles, compared bit for bit
+void CoreTests::timeSeriesEdgeCases() {
+    const double values[] = { 0.0, -0.0, 1.0, 1.0, 1.0, 0.1, std::numeric_limits<double>::max(),
+                              -std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min(),
+                              std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                              std::numeric_limits<double>::quiet_NaN(), 4294967295.0, 0.0, 12345.0, 12346.0 };
+    // Delta-of-delta in ticks: both sides of every bucket edge, then an hour
+    const qint64 deltaOfDeltas[] = { 0, 2048, -2048, 2047, -2047, 256, -256, 255, -255, 64, -64, 63, -63,
+                                     360000000, -359999900 };
+    const int count = int(sizeof(values) / sizeof(values[0]));
+    static_assert(sizeof(deltaOfDeltas) / sizeof(deltaOfDeltas[0]) == sizeof(values) / sizeof(values[0]) - 1,
+                  "one delta-of-delta per gap");
+
+    // Sub-tick offsets are dropped by the encoder
+    const qint64 firstNs = 123456789;
+    QVector<qint64> times;
+    times.append(firstNs);
+    qint64 ticks = 0;
+    qint64 delta = 0;
+    for (int i = 1; i < count; ++i) {
+        delta += deltaOfDeltas[i - 1];
+        ticks += delta;
+        times.append(firstNs + ticks * TimeSeriesEncoder::TickNs + (i * 1237) % TimeSeriesEncoder::TickNs);
+    }
+
+    TimeSeriesEncoder encoder;
+    for (int i = 0; i < count; ++i)
+        encoder.append(times[i], values[i]);
+    QCOMPARE(encoder.sampleCount(), count);
+    const QByteArray &payload = encoder.finish();
+
+    TimeSeriesDecoder decoder(reinterpret_cast<const uchar *>(payload.constData()), payload.size(), count, encoder.firstNs());
+    for (int i = 0; i < count; ++i) {
+        qint64 timeNs;
+        double value;
+        QVERIFY2(decoder.next(timeNs, value), qPrintable(QString("sample %1").arg(i)));
+        QVERIFY2(sameTime(timeNs, times[i]), qPrintable(QString("time of sample %1").arg(i)));
+        QVERIFY2(memcmp(&value, &values[i], sizeof(value)) == 0, qPrintable(QString("value of sample %1").arg(i)));
+    }
+    qint64 timeNs;
+    double value;
+    QVERIFY(!decoder.next(timeNs, value));
+
+    // A block cut short ends early instead of reading past its payload
+    TimeSeriesDecoder truncated(reinterpret_cast<const uchar *>(payload.constData()), payload.size() / 2, count, encoder.firstNs());
+    int decoded = 0;
+    while (truncated.next(timeNs, value))
+        ++decoded;
+    QVERIFY(decoded < count);
+}
+
+// Factor changes, a silent channel, a gap past the block span, extreme raw
+// values and a log read both through its index and without one
+void CoreTests::compressedLogRoundTrip() {
+    QVector<BinaryLogSensorDescriptor> sensors;
+    sensors.append(binaryLogSensor(0x01, 0x11, "Pressure", "bar", 0, 1000));
+    sensors.append(binaryLogSensor(0x02, 0, "Speed", "rpm", 0, 9000));
+
+    const QString fileName = directory.filePath("roundtrip.emsz");
+    const QString unclosedName = directory.filePath("unclosed.emsz");
+    CompressedLogWriter writer;
+    QVERIFY(writer.open(fileName, sensors));
+
+    QVector<LoggedSample> logged;
+    const int frames = 5000;
+    qint64 timeNs = 1000000000;
+    quint32 state = 1;
+    for (int n = 0; n < frames; ++n) {
+        state = state * 1103515245 + 12345;
+        timeNs += 1000000 + qint64(state >> 16) % 600000 - 300000;
+        if (n == 3000)
+            timeNs += 2 * CompressedLogWriter::MaxBlockSpanNs;
+
+        DecodedFrame frame;
+        frame.arrivalNs = timeNs;
+        frame.counter = quint8(n);
+        frame.sensorCount = 0;
+        const quint32 raw = n % 997 == 0 ? 0xFFFFFFFF : n % 991 == 0 ? 0 : 5000 + (state >> 20) % 64;
+        const quint32 factor = n < 2000 ? 10 : 100;
+        frame.samples[frame.sensorCount++] = { 0x01, raw, factor, 0 };
+        frame.samples[frame.sensorCount++] = { 0x11, quint32(n % 1000 == 500), 0, 0 };
+        if (n < 100)
+            frame.samples[frame.sensorCount++] = { 0x02, quint32(n * 7), 1, 0 };
+        frame.samples[frame.sensorCount++] = { 0x33, 1, 1, 0 }; // not logged
+        for (int i = 0; i < frame.sensorCount - 1; ++i) {
+            const SensorSample &sample = frame.samples[i];
+            logged.append({ sample.id, timeNs, sample.factor == 0 ? double(sample.rawValue) : double(sample.rawValue) / sample.factor });
+        }
+        QVERIFY(writer.write(frame));
+
+        if (n == 1000) {
+            // Speed stopped reporting; its open block is sealed by age alone
+            const qint64 before = writer.size();
+            QVERIFY(writer.sealExpired(timeNs));
+            QCOMPARE(writer.size(), before);
+            QVERIFY(writer.sealExpired(timeNs + CompressedLogWriter::MaxBlockSpanNs));
+            QVERIFY(writer.size() > before);
+            QVERIFY(writer.flush());
+            QVERIFY(QFile::copy(fileName, unclosedName));
+        }
+    }
+    writer.close();
+
+    CompressedLogReader reader;
+    QVERIFY2(reader.open(fileName), qPrintable(reader.errorString()));
+    QCOMPARE(reader.sensorCount(), 2);
+    QCOMPARE(int(reader.sensor(1).id), 0x02);
+    QVERIFY(reader.header().indexOffset > 0);
+    for (int i = 0; i < reader.blockCount(); ++i) {
+        const CompressedLogBlock &block = reader.block(i);
+        QVERIFY(block.sampleCount <= quint32(CompressedLogWriter::BlockSamples));
+        QVERIFY(block.lastNs - block.firstNs < CompressedLogWriter::MaxBlockSpanNs);
+        QCOMPARE(block.offset % 8, qint64(0));
+    }
+
+    const quint8 ids[] = { 0x01, 0x11, 0x02 };
+    for (quint8 id : ids) {
+        QVector<CompressedSample> samples;
+        QVERIFY(reader.read(id, 0, std::numeric_limits<qint64>::max(), samples));
+        int expected = 0;
+        for (const LoggedSample &sample : logged) {
+            if (sample.id != id)
+                continue;
+            QVERIFY(expected < samples.size());
+            QVERIFY(sameTime(samples[expected].timeNs, sample.timeNs));
+            QCOMPARE(samples[expected].value, sample.value);
+            ++expected;
+        }
+        QCOMPARE(samples.size(), expected);
+    }
+    QVector<CompressedSample> unknown;
+    QVERIFY(reader.read(0x33, 0, std::numeric_limits<qint64>::max(), unknown));
+    QVERIFY(unknown.isEmpty());
+
+    // A range decodes only its own samples, across the factor change
+    QVector<LoggedSample> pressure;
+    for (const LoggedSample &sample : logged) {
+        if (sample.id == 0x01)
+            pressure.append(sample);
+    }
+    QVector<CompressedSample> range;
+    QVERIFY(reader.read(0x01, pressure[1500].timeNs - TimeSeriesEncoder::TickNs + 1, pressure[2499].timeNs, range));
+    QCOMPARE(range.size(), 1000);
+    QCOMPARE(range.first().value, pressure[1500].value);
+    QCOMPARE(range.last().value, pressure[2499].value);
+
+    // The copy taken while writing has no index; its sealed blocks are found by walking
+    CompressedLogReader unclosed;
+    QVERIFY2(unclosed.open(unclosedName), qPrintable(unclosed.errorString()));
+    QCOMPARE(unclosed.header().indexOffset, qint64(0));
+    QVERIFY(unclosed.blockCount() > 0);
+    QVector<CompressedSample> speed;
+    QVERIFY(unclosed.read(0x02, 0, std::numeric_limits<qint64>::max(), speed));
+    QCOMPARE(speed.size(), 100);
+    QCOMPARE(speed.last().value, 99.0 * 7);
+}
+
+void CoreTests::quantileEstimates() {
+    // Nearest rank until the five markers are filled
+    P2Quantile median(0.5);
+    QCOMPARE(median.value(), 0.0);
+    median.add(5);
+    median.add(1);
+    median.add(4);
+    QCOMPARE(median.value(), 4.0);
+
+    // 1..10000 in a scrambled order; P² lands within 1 % of the range
+    P2Quantile p50(0.50);
+    P2Quantile p95(0.95);
+    P2Quantile p99(0.99);
+    for (int i = 1; i <= 10000; ++i) {
+        const double value = (i * 7919) % 10001;
+        p50.add(value);
+        p95.add(value);
+        p99.add(value);
+    }
+    QVERIFY(std::abs(p50.value() - 5000) < 100);
+    QVERIFY(std::abs(p95.value() - 9500) < 100);
+    QVERIFY(std::abs(p99.value() - 9900) < 100);
+
+    // A constant series has that constant as every quantile
+    P2Quantile constant(0.95);
+    for (int i = 0; i < 100; ++i)
+        constant.add(42);
+    QCOMPARE(constant.value(), 42.0);
+}
+
+void CoreTests::runStatistics() {
+    RunStatistics statistics;
+    statistics.setChannels({ 0x01, 0x02 });
+    const double values[] = { 2, 4, 4, 4, 5, 5, 7, 9 };
+    for (double value : values)
+        statistics.add(0x01, value);
+    // A large offset must not cost precision
+    const double offsets[] = { 4, 7, 13, 16 };
+    for (double offset : offsets)
+        statistics.add(0x02, 1e9 + offset);
+    statistics.add(0x33, 1000); // no channel
+
+    QVector<SensorStatistics> summary = statistics.summary(3);
+    QCOMPARE(summary.size(), 2);
+    QCOMPARE(int(summary[0].source), 3);
+    QCOMPARE(int(summary[0].id), 0x01);
+    QCOMPARE(summary[0].count, quint64(8));
+    QCOMPARE(summary[0].minimum, 2.0);
+    QCOMPARE(summary[0].maximum, 9.0);
+    QCOMPARE(summary[0].mean, 5.0);
+    QVERIFY(std::abs(summary[0].standardDeviation - std::sqrt(32.0 / 7)) < 1e-12);
+    QCOMPARE(summary[1].count, quint64(4));
+    QVERIFY(std::abs(summary[1].mean - (1e9 + 10)) < 1e-6);
+    QVERIFY(std::abs(summary[1].standardDeviation - std::sqrt(30.0)) < 1e-6);
+
+    statistics.clear();
+    summary = statistics.summary();
+    QCOMPARE(summary[0].count, quint64(0));
+    QCOMPARE(summary[0].standardDeviation, 0.0);
+}
+
+QTEST_GUILESS_MAIN(CoreTests)
+
+#include "tst_coretests.moc"
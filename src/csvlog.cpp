@@ -0,0 +1,71 @@
+#include "csvlog.h"
+#include <cmath>
+
+CsvLogWriter::CsvLogWriter() : bufferSize(0) {
+}
+
+CsvLogWriter::~CsvLogWriter() {
+    close();
+}
+
+bool CsvLogWriter::open(const QString &fileName) {
+    close();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::Append | QIODevice::Text))
+        return false;
+    pending.reserve(bufferSize + 4096);
+    return true;
+}
+
+void CsvLogWriter::close() {
+    if (!file.isOpen())
+        return;
+    flush();
+    file.close();
+}
+
+// Same text as QString::number(value, 'f', 1), without allocating and
+// independent of the C locale
+static void appendFixed1(QByteArray &out, double value) {
+    char digits[32];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+
+    qint64 tenths = qint64(std::llround(value * 10.0));
+    const bool negative = tenths < 0;
+    quint64 magnitude = negative ? quint64(-tenths) : quint64(tenths);
+
+    *--p = char('0' + magnitude % 10);
+    *--p = '.';
+    magnitude /= 10;
+    do {
+        *--p = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative)
+        *--p = '-';
+    out.append(p, int(end - p));
+}
+
+bool CsvLogWriter::write(const DecodedFrame &frame) {
+    if (frame.sensorCount >= 10)
+        pending.append(char('0' + frame.sensorCount / 10));
+    pending.append(char('0' + frame.sensorCount % 10));
+    for (int i = 0; i < frame.sensorCount; ++i) {
+        pending.append(',');
+        appendFixed1(pending, frame.samples[i].value);
+    }
+    pending.append('\n');
+
+    if (pending.size() < bufferSize)
+        return true;
+    return flush();
+}
+
+bool CsvLogWriter::flush() {
+    if (pending.isEmpty())
+        return true;
+    const bool written = file.write(pending) == pending.size();
+    pending.resize(0); // keeps the reserved capacity
+    return file.flush() && written;
+}
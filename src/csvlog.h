@@ -0,0 +1,33 @@
+#ifndef CSVLOG_H
+#define CSVLOG_H
+
+#include <QFile>
+#include <QString>
+#include "framedecoder.h"
+
+// Appends one text row per frame: the sensor count followed by every
+// scaled value with one decimal. Rows are collected in memory and written
+// in large blocks.
+class CsvLogWriter {
+public:
+    CsvLogWriter();
+    ~CsvLogWriter();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    QString errorString() const { return file.errorString(); }
+
+    void setBufferSize(int bytes) { bufferSize = bytes; }
+    bool write(const DecodedFrame &frame);
+    bool flush();
+
+private:
+    Q_DISABLE_COPY(CsvLogWriter)
+
+    QFile file;
+    QByteArray pending;
+    int bufferSize;
+};
+
+#endif // CSVLOG_H
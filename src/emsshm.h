@@ -0,0 +1,119 @@
+/*
+ * Latest-value shared memory segment of the Engine Monitoring System.
+ *
+ * The monitor publishes the newest sample of every sensor ID into a POSIX
+ * shared memory object per serial port: EMS_SHM_NAME for port 1,
+ * EMS_SHM_NAME "_port2" for port 2 and so on. Local processes map it
+ * read-only and poll it at any rate; the acquisition thread never waits
+ * for them.
+ *
+ *   int fd = shm_open(EMS_SHM_NAME, O_RDONLY, 0);
+ *   const ems_shm_segment *segment = mmap(NULL, sizeof(ems_shm_segment),
+ *                                         PROT_READ, MAP_SHARED, fd, 0);
+ *   ems_shm_sensor oil;
+ *   if (ems_shm_valid(segment) && ems_shm_read(segment, 0x01, &oil))
+ *       printf("%g\n", oil.value);
+ *
+ * Every sensor record is guarded by its own sequence lock: the writer makes
+ * sequence odd, updates the record and makes it even again. ems_shm_read()
+ * copies a record and retries when the sequence was odd or moved, at most
+ * EMS_SHM_READ_ATTEMPTS times. Records sit on their own 64-byte cache line.
+ *
+ * Host byte order. Plain C99; the atomics are the GCC/Clang builtins.
+ */
+
+#ifndef EMSSHM_H
+#define EMSSHM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define EMS_SHM_NAME "/ems_latest"
+#define EMS_SHM_MAGIC 0x53534D45u /* "EMSS" */
+#define EMS_SHM_VERSION 1u
+#define EMS_SHM_SENSOR_COUNT 256
+#define EMS_SHM_READ_ATTEMPTS 64
+
+enum ems_shm_kind {
+    EMS_SHM_UNUSED = 0,
+    EMS_SHM_VALUE = 1,
+    EMS_SHM_STATUS = 2
+};
+
+typedef struct ems_shm_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;        /* offset of sensors[0] */
+    uint32_t sensor_size;
+    uint32_t sensor_count;
+    uint32_t source;             /* serial port, 0 for port 1 */
+    int32_t writer_pid;
+    uint32_t reserved0;
+    int64_t start_monotonic_ns;  /* writer's CLOCK_MONOTONIC when created */
+    int64_t start_utc_us;        /* the same instant on the wall clock */
+    uint64_t frames;             /* decoded frames, updated atomically */
+    uint8_t reserved[8];
+} ems_shm_header;
+
+typedef struct ems_shm_sensor {
+    uint32_t sequence;  /* odd while the writer updates the record */
+    uint8_t id;
+    uint8_t kind;       /* enum ems_shm_kind */
+    uint8_t error;      /* error flag of a value sensor, from its status ID */
+    uint8_t reserved0;
+    int64_t time_ns;    /* arrival on the writer's CLOCK_MONOTONIC, 0 if never received */
+    int64_t utc_us;     /* arrival on the wall clock */
+    double value;       /* raw_value / factor, or raw_value when factor is 0 */
+    uint32_t raw_value;
+    uint32_t factor;
+    uint64_t updates;   /* samples received since the segment was created */
+    uint8_t reserved[16];
+} ems_shm_sensor;
+
+typedef struct ems_shm_segment {
+    ems_shm_header header;
+    ems_shm_sensor sensors[EMS_SHM_SENSOR_COUNT];
+} ems_shm_segment;
+
+#ifdef __cplusplus
+static_assert(sizeof(ems_shm_header) == 64, "ems_shm_header layout changed");
+static_assert(sizeof(ems_shm_sensor) == 64, "ems_shm_sensor layout changed");
+#else
+/* C99 has no _Static_assert: a negative array size fails the build */
+typedef char ems_shm_header_size_check[sizeof(ems_shm_header) == 64 ? 1 : -1];
+typedef char ems_shm_sensor_size_check[sizeof(ems_shm_sensor) == 64 ? 1 : -1];
+#endif
+
+static inline int ems_shm_valid(const ems_shm_segment *segment)
+{
+    return segment->header.magic == EMS_SHM_MAGIC && segment->header.version == EMS_SHM_VERSION
+        && segment->header.sensor_size == sizeof(ems_shm_sensor)
+        && segment->header.sensor_count == EMS_SHM_SENSOR_COUNT;
+}
+
+/* Copies a consistent snapshot of sensor id into out. Returns 0 when the
+ * writer kept the record busy for every attempt. */
+static inline int ems_shm_read(const ems_shm_segment *segment, uint8_t id, ems_shm_sensor *out)
+{
+    const ems_shm_sensor *sensor = &segment->sensors[id];
+    int attempt;
+    for (attempt = 0; attempt < EMS_SHM_READ_ATTEMPTS; ++attempt) {
+        const uint32_t begin = __atomic_load_n(&sensor->sequence, __ATOMIC_ACQUIRE);
+        if (begin & 1u)
+            continue;
+        memcpy(out, sensor, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&sensor->sequence, __ATOMIC_RELAXED) == begin) {
+            out->sequence = begin;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static inline uint64_t ems_shm_frames(const ems_shm_segment *segment)
+{
+    return __atomic_load_n(&segment->header.frames, __ATOMIC_RELAXED);
+}
+
+#endif /* EMSSHM_H */
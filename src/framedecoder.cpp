@@ -0,0 +1,47 @@
+#include "framedecoder.h"
+#include "framescan.h"
+#include <QtEndian>
+#include <cstring>
+
+bool decodeFrame(const quint8 *frame, int size, DecodedFrame &out) {
+    const int sensorCount = frame[FrameReassembler::HeaderSize + 1];
+    if (sensorCount > FrameReassembler::MaxSensors
+        || size != FrameReassembler::MinFrameSize + sensorCount * FrameReassembler::SensorBlockSize)
+        return false;
+
+    out.counter = frame[FrameReassembler::HeaderSize];
+    out.sensorCount = quint8(sensorCount);
+
+    // Sensor block: id, reserved, value (4), factor (4)
+    const quint8 *block = frame + FrameReassembler::HeaderSize + 2;
+    for (int i = 0; i < sensorCount; ++i, block += FrameReassembler::SensorBlockSize) {
+        SensorSample &sample = out.samples[i];
+        sample.id = block[0];
+        sample.rawValue = qFromLittleEndian<quint32>(block + 2);
+        sample.factor = qFromLittleEndian<quint32>(block + 6);
+        sample.value = sample.factor == 0 ? sample.rawValue : static_cast<double>(sample.rawValue) / sample.factor;
+    }
+    return true;
+}
+
+int encodeFrame(const DecodedFrame &frame, quint8 *out) {
+    const int sensorCount = qMin(int(frame.sensorCount), FrameReassembler::MaxSensors);
+    const int size = FrameReassembler::MinFrameSize + sensorCount * FrameReassembler::SensorBlockSize;
+
+    memset(out, 0xA5, FrameReassembler::HeaderSize);
+    out[FrameReassembler::HeaderSize] = frame.counter;
+    out[FrameReassembler::HeaderSize + 1] = quint8(sensorCount);
+
+    quint8 *block = out + FrameReassembler::HeaderSize + 2;
+    for (int i = 0; i < sensorCount; ++i, block += FrameReassembler::SensorBlockSize) {
+        const SensorSample &sample = frame.samples[i];
+        block[0] = sample.id;
+        block[1] = 0;
+        qToLittleEndian<quint32>(sample.rawValue, block + 2);
+        qToLittleEndian<quint32>(sample.factor, block + 6);
+    }
+
+    qToLittleEndian<quint16>(frameChecksum(out + FrameReassembler::HeaderSize, size - FrameReassembler::HeaderSize - 3), out + size - 3);
+    out[size - 1] = 0x55;
+    return size;
+}
@@ -0,0 +1,32 @@
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include <QtGlobal>
+#include "framereassembler.h"
+
+struct SensorSample {
+    quint8 id;
+    quint32 rawValue;
+    quint32 factor;
+    double value; // rawValue / factor, or rawValue when factor is 0
+};
+
+struct DecodedFrame {
+    qint64 arrivalNs; // monotonicNanoseconds() when the last byte was read
+    qint64 decodedNs; // monotonicNanoseconds() after decoding
+    quint8 source;    // index of the acquisition source, set by its worker
+    quint8 counter;
+    quint8 sensorCount;
+    SensorSample samples[FrameReassembler::MaxSensors];
+};
+
+// Decodes a frame that FrameReassembler already validated. Fields are read
+// little-endian straight out of the frame bytes; nothing is allocated.
+bool decodeFrame(const quint8 *frame, int size, DecodedFrame &out);
+
+// Inverse of decodeFrame(): writes the wire form of id, rawValue and factor
+// of each sample, with checksum and footer, and returns its length. out must
+// hold FrameReassembler::MaxFrameSize bytes.
+int encodeFrame(const DecodedFrame &frame, quint8 *out);
+
+#endif // FRAMEDECODER_H
@@ -0,0 +1,111 @@
+#include "framereassembler.h"
+#include "framescan.h"
+#include <cstring>
+
+static const quint8 HeaderByte = 0xA5;
+static const quint8 FooterByte = 0x55;
+
+FrameReassembler::FrameReassembler() {
+    reset();
+}
+
+void FrameReassembler::reset() {
+    head = 0;
+    tail = 0;
+    dropped = 0;
+    rejected = 0;
+}
+
+int FrameReassembler::append(const char *data, int size) {
+    const int room = Capacity - bytesAvailable();
+    const int count = size < room ? size : room;
+    const quint32 start = head & (Capacity - 1);
+    const int firstPart = count < int(Capacity - start) ? count : int(Capacity - start);
+    memcpy(ring + start, data, firstPart);
+    memcpy(ring, data + firstPart, count - firstPart);
+    head += count;
+    return count;
+}
+
+void FrameReassembler::discard(int count) {
+    tail += count;
+}
+
+bool FrameReassembler::headerAt(int offset) const {
+    if (offset + HeaderSize > bytesAvailable())
+        return false;
+    for (int i = 0; i < HeaderSize; ++i) {
+        if (at(offset + i) != HeaderByte)
+            return false;
+    }
+    return true;
+}
+
+// Drops everything in front of the first header. Keeps a trailing partial
+// header so that a header split across two reads is not lost.
+bool FrameReassembler::findHeader() {
+    const int available = bytesAvailable();
+    const quint32 start = tail & (Capacity - 1);
+    const int firstPart = qMin(available, int(Capacity - start));
+
+    int offset = int(findFrameHeader(ring + start, firstPart));
+    if (offset == firstPart && firstPart < available) {
+        // The header may straddle the end of the ring
+        offset = qMax(0, firstPart - (HeaderSize - 1));
+        while (offset < firstPart && !headerAt(offset))
+            ++offset;
+        if (offset == firstPart)
+            offset += int(findFrameHeader(ring, available - firstPart));
+    }
+
+    if (offset + HeaderSize <= available) {
+        dropped += offset;
+        discard(offset);
+        return true;
+    }
+
+    int partial = 0;
+    while (partial < HeaderSize - 1 && partial < available && at(available - 1 - partial) == HeaderByte)
+        ++partial;
+    dropped += available - partial;
+    discard(available - partial);
+    return false;
+}
+
+int FrameReassembler::nextFrame() {
+    while (findHeader()) {
+        if (bytesAvailable() < HeaderSize + 2)
+            return 0;
+
+        const int idCount = at(HeaderSize + 1);
+        if (idCount > MaxSensors) {
+            ++rejected;
+            ++dropped;
+            discard(1);
+            continue;
+        }
+
+        const int frameSize = MinFrameSize + idCount * SensorBlockSize;
+        if (bytesAvailable() < frameSize)
+            return 0;
+
+        const quint32 start = tail & (Capacity - 1);
+        const int firstPart = qMin(frameSize, int(Capacity - start));
+        memcpy(frameBuffer, ring + start, firstPart);
+        memcpy(frameBuffer + firstPart, ring, frameSize - firstPart);
+
+        // The device sends the checksum little-endian
+        const quint16 checksum = quint16(frameBuffer[frameSize - 2] << 8) | frameBuffer[frameSize - 3];
+        if (frameBuffer[frameSize - 1] == FooterByte
+            && frameChecksum(frameBuffer + HeaderSize, frameSize - HeaderSize - 3) == checksum) {
+            discard(frameSize);
+            return frameSize;
+        }
+
+        // Not a real frame: skip this header and resynchronise
+        ++rejected;
+        ++dropped;
+        discard(1);
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef FRAMEREASSEMBLER_H
+#define FRAMEREASSEMBLER_H
+
+#include <QtGlobal>
+
+// Cuts the raw serial byte stream into complete protocol frames.
+//
+// Bytes are accumulated in a ring buffer; nextFrame() looks for the
+// A5A5A5A5 header, reads the ID count to learn the frame length and only
+// hands out frames whose footer and checksum are valid. On garbage or a
+// corrupted frame it drops a single byte and searches for the next header.
+class FrameReassembler {
+public:
+    static constexpr int HeaderSize = 4;
+    static constexpr int SensorBlockSize = 10;
+    static constexpr int MaxSensors = 30;
+    static constexpr int MinFrameSize = 9; // header + counter + count + checksum + footer
+    static constexpr int MaxFrameSize = MinFrameSize + MaxSensors * SensorBlockSize;
+    static constexpr int Capacity = 4096; // must be a power of two
+
+    FrameReassembler();
+
+    // Appends up to size bytes and returns how many were taken. The buffer
+    // always has room for Capacity - MaxFrameSize bytes once nextFrame()
+    // returned 0.
+    int append(const char *data, int size);
+
+    // Returns the length of the next complete frame, or 0 if more bytes are
+    // needed. The frame stays available through frame() until the next call.
+    int nextFrame();
+    const quint8 *frame() const { return frameBuffer; }
+
+    void reset();
+
+    int bytesAvailable() const { return int(head - tail); }
+    quint64 droppedBytes() const { return dropped; }
+    quint64 badFrames() const { return rejected; }
+
+private:
+    quint8 at(int offset) const { return ring[(tail + offset) & (Capacity - 1)]; }
+    void discard(int count);
+    bool headerAt(int offset) const;
+    bool findHeader();
+
+    quint8 ring[Capacity];
+    quint8 frameBuffer[MaxFrameSize];
+    quint32 head;
+    quint32 tail;
+    quint64 dropped;
+    quint64 rejected;
+};
+
+#endif // FRAMEREASSEMBLER_H
@@ -0,0 +1,193 @@
+#include "framescan.h"
+#include "framereassembler.h"
+
+#if defined(Q_PROCESSOR_X86) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+#  define FRAMESCAN_X86
+#  include <immintrin.h>
+#endif
+
+static const quint8 HeaderByte = 0xA5;
+static const quint8 FooterByte = 0x55;
+
+static qint64 findHeaderScalar(const quint8 *data, qint64 size) {
+    qint64 i = 0;
+    while (i + 4 <= size) {
+        // Any position whose fourth byte is not 0xA5 can be skipped together
+        // with the three before it
+        if (data[i + 3] != HeaderByte) {
+            i += 4;
+        } else if (data[i + 2] != HeaderByte) {
+            i += 3;
+        } else if (data[i + 1] != HeaderByte) {
+            i += 2;
+        } else if (data[i] != HeaderByte) {
+            i += 1;
+        } else {
+            return i;
+        }
+    }
+    return size;
+}
+
+static quint16 checksumScalar(const quint8 *data, qint64 size) {
+    quint32 sum = 0;
+    for (qint64 i = 0; i < size; ++i)
+        sum += data[i];
+    return quint16(sum);
+}
+
+#ifdef FRAMESCAN_X86
+
+// Stored rather than moved out with _mm_cvtsi128_si64, which 32-bit x86 lacks
+__attribute__((target("sse2")))
+static quint64 sumLanes(__m128i acc) {
+    quint64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc);
+    return lanes[0] + lanes[1];
+}
+
+__attribute__((target("sse2")))
+static qint64 findHeaderSse2(const quint8 *data, qint64 size) {
+    const __m128i pattern = _mm_set1_epi8(char(HeaderByte));
+    qint64 i = 0;
+    for (; i + 16 + 3 <= size; i += 16) {
+        const __m128i m0 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), pattern);
+        const __m128i m1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 1)), pattern);
+        const __m128i m2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 2)), pattern);
+        const __m128i m3 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 3)), pattern);
+        const int mask = _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(m0, m1), _mm_and_si128(m2, m3)));
+        if (mask)
+            return i + __builtin_ctz(unsigned(mask));
+    }
+    return i + findHeaderScalar(data + i, size - i);
+}
+
+__attribute__((target("sse2")))
+static quint16 checksumSse2(const quint8 *data, qint64 size) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc0 = zero;
+    __m128i acc1 = zero;
+    qint64 i = 0;
+    for (; i + 32 <= size; i += 32) {
+        acc0 = _mm_add_epi64(acc0, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), zero));
+        acc1 = _mm_add_epi64(acc1, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 16)), zero));
+    }
+    return quint16(sumLanes(_mm_add_epi64(acc0, acc1)) + checksumScalar(data + i, size - i));
+}
+
+__attribute__((target("avx2")))
+static qint64 findHeaderAvx2(const quint8 *data, qint64 size) {
+    const __m256i pattern = _mm256_set1_epi8(char(HeaderByte));
+    qint64 i = 0;
+    for (; i + 32 + 3 <= size; i += 32) {
+        const __m256i m0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), pattern);
+        const __m256i m1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 1)), pattern);
+        const __m256i m2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 2)), pattern);
+        const __m256i m3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 3)), pattern);
+        const unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(m0, m1), _mm256_and_si256(m2, m3))));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    _mm256_zeroupper();
+    return i + findHeaderScalar(data + i, size - i);
+}
+
+__attribute__((target("avx2")))
+static quint16 checksumAvx2(const quint8 *data, qint64 size) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc0 = zero;
+    __m256i acc1 = zero;
+    qint64 i = 0;
+    for (; i + 64 <= size; i += 64) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 32)), zero));
+    }
+    const __m256i acc = _mm256_add_epi64(acc0, acc1);
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    // Finish inside this function: calling the SSE2 kernel with dirty upper
+    // AVX state costs more than the whole tail
+    for (; i + 16 <= size; i += 16)
+        half = _mm_add_epi64(half, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), _mm_setzero_si128()));
+    quint64 sum = sumLanes(half);
+    for (; i < size; ++i)
+        sum += data[i];
+    return quint16(sum);
+}
+
+#endif // FRAMESCAN_X86
+
+namespace {
+
+struct ScanKernels {
+    qint64 (*findHeader)(const quint8 *, qint64);
+    quint16 (*checksum)(const quint8 *, qint64);
+    const char *name;
+};
+
+ScanKernels selectKernels() {
+#ifdef FRAMESCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return { findHeaderAvx2, checksumAvx2, "avx2" };
+    if (__builtin_cpu_supports("sse2"))
+        return { findHeaderSse2, checksumSse2, "sse2" };
+#endif
+    return { findHeaderScalar, checksumScalar, "scalar" };
+}
+
+const ScanKernels &kernels() {
+    static const ScanKernels selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+qint64 findFrameHeader(const quint8 *data, qint64 size) {
+    return kernels().findHeader(data, size);
+}
+
+quint16 frameChecksum(const quint8 *data, qint64 size) {
+    return kernels().checksum(data, size);
+}
+
+const char *frameScanKernel() {
+    return kernels().name;
+}
+
+qint64 scanFrames(const quint8 *data, qint64 size, QVector<qint64> &offsets) {
+    const ScanKernels &k = kernels();
+    qint64 pos = 0;
+    while (pos < size) {
+        pos += k.findHeader(data + pos, size - pos);
+        if (pos == size) {
+            // Keep a partial header at the end for the next call
+            int partial = 0;
+            while (partial < FrameReassembler::HeaderSize - 1 && partial < size && data[size - 1 - partial] == HeaderByte)
+                ++partial;
+            return size - partial;
+        }
+        if (size - pos < FrameReassembler::HeaderSize + 2)
+            break;
+
+        const int idCount = data[pos + FrameReassembler::HeaderSize + 1];
+        if (idCount > FrameReassembler::MaxSensors) {
+            ++pos;
+            continue;
+        }
+
+        const qint64 frameSize = FrameReassembler::MinFrameSize + idCount * FrameReassembler::SensorBlockSize;
+        if (size - pos < frameSize)
+            break;
+
+        const quint8 *frame = data + pos;
+        const quint16 expected = quint16(frame[frameSize - 2] << 8) | frame[frameSize - 3]; // little-endian
+        if (frame[frameSize - 1] == FooterByte
+            && k.checksum(frame + FrameReassembler::HeaderSize, frameSize - FrameReassembler::HeaderSize - 3) == expected) {
+            offsets.append(pos);
+            pos += frameSize;
+        } else {
+            ++pos;
+        }
+    }
+    return pos;
+}
@@ -0,0 +1,27 @@
+#ifndef FRAMESCAN_H
+#define FRAMESCAN_H
+
+#include <QtGlobal>
+#include <QVector>
+
+// Bulk helpers for locating and validating frames in large buffers, e.g.
+// when replaying captures or catching up after a stall. The SSE2 and AVX2
+// kernels are picked once at startup from what the CPU supports; every
+// other platform uses the scalar code.
+
+// Offset of the first A5A5A5A5 header in data, or size if there is none
+qint64 findFrameHeader(const quint8 *data, qint64 size);
+
+// 16-bit additive checksum used by the protocol
+quint16 frameChecksum(const quint8 *data, qint64 size);
+
+// Validates back-to-back frames in one pass and appends the offset of every
+// valid frame to offsets. Garbage and corrupted frames are skipped. Returns
+// the number of bytes fully processed; anything after that is the start of
+// a frame that is not complete yet.
+qint64 scanFrames(const quint8 *data, qint64 size, QVector<qint64> &offsets);
+
+// Name of the kernel chosen at runtime ("avx2", "sse2" or "scalar")
+const char *frameScanKernel();
+
+#endif // FRAMESCAN_H
@@ -0,0 +1,62 @@
+#include "framegenerator.h"
+#include "sensorregistry.h"
+#include <cmath>
+
+static const int ValueSensors = int(sizeof(BuiltinSensorList) / sizeof(BuiltinSensorList[0]));
+
+FrameGenerator::FrameGenerator(int sensorCount, int profiles, quint32 seed)
+    : sensorCount(qBound(0, sensorCount, FrameReassembler::MaxSensors)), profiles(profiles), corruptionRate(0.01),
+      state(seed ? seed : 1), counter(0) {
+    for (bool &error : errors)
+        error = false;
+}
+
+// xorshift32, deterministic for a given seed
+quint32 FrameGenerator::random() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+int FrameGenerator::next(double seconds, quint8 *out) {
+    // Counter 0 is what the receiver starts from, so it is never sent
+    if (++counter == 0)
+        counter = 1;
+    frame.counter = counter;
+    frame.sensorCount = quint8(sensorCount);
+
+    for (int i = 0; i < sensorCount; ++i) {
+        SensorSample &sample = frame.samples[i];
+        const int index = i % ValueSensors;
+        const BuiltinSensor &sensor = BuiltinSensorList[index];
+
+        if (i >= ValueSensors) {
+            if ((profiles & ErrorFlags) && uniform() < 0.002)
+                errors[index] = !errors[index];
+            sample.id = quint8(sensor.id + 0x10);
+            sample.rawValue = errors[index] ? 1 : 0;
+            sample.factor = 0;
+            continue;
+        }
+
+        const double range = sensor.maxValue - sensor.minValue;
+        double value = sensor.minValue + range / 2;
+        if (profiles & Ramp) {
+            // Phase shifted per sensor so the gauges do not move in lockstep
+            const double phase = std::fmod(seconds / RampPeriod + double(index) / ValueSensors, 1.0);
+            value = sensor.minValue + phase * range;
+        }
+        if (profiles & Noise)
+            value = qBound(double(sensor.minValue), value + (uniform() - 0.5) * 0.04 * range, double(sensor.maxValue));
+
+        sample.id = sensor.id;
+        sample.rawValue = quint32(std::lround(value * Factor));
+        sample.factor = Factor;
+    }
+
+    const int size = encodeFrame(frame, out);
+    if ((profiles & BadChecksum) && uniform() < corruptionRate)
+        out[size - 2] ^= 0xFF;
+    return size;
+}
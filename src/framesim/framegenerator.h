@@ -0,0 +1,44 @@
+#ifndef FRAMEGENERATOR_H
+#define FRAMEGENERATOR_H
+
+#include <QtGlobal>
+#include "framedecoder.h"
+
+// Produces protocol-correct frames for the built-in sensors. A frame with
+// sensorCount blocks carries the values of sensors 0x01.. first and then
+// their error flags 0x11.., the order the device uses, so 30 blocks cover
+// every value and flag.
+class FrameGenerator {
+public:
+    enum Profile {
+        Ramp = 0x01,        // each value sweeps its range every RampPeriod seconds
+        Noise = 0x02,       // adds +-2% of the range
+        ErrorFlags = 0x04,  // flags toggle now and then
+        BadChecksum = 0x08  // corruptionRate of the frames get a wrong checksum
+    };
+
+    static constexpr double RampPeriod = 10.0;
+    static constexpr quint32 Factor = 10; // one decimal
+
+    explicit FrameGenerator(int sensorCount = FrameReassembler::MaxSensors, int profiles = Ramp, quint32 seed = 1);
+
+    void setCorruptionRate(double fraction) { corruptionRate = fraction; }
+
+    // Writes the frame for the given time into out, which must hold
+    // FrameReassembler::MaxFrameSize bytes, and returns its length
+    int next(double seconds, quint8 *out);
+
+    quint32 random();
+    double uniform() { return (random() >> 8) * (1.0 / 16777216.0); }
+
+private:
+    int sensorCount;
+    int profiles;
+    double corruptionRate;
+    quint32 state;
+    quint8 counter;
+    bool errors[16];
+    DecodedFrame frame;
+};
+
+#endif // FRAMEGENERATOR_H
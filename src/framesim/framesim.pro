@@ -0,0 +1,23 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = framesim
+
+# Shares the protocol code with the monitor
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    framegenerator.cpp \
+    ../framedecoder.cpp \
+    ../framereassembler.cpp \
+    ../framescan.cpp
+
+HEADERS += \
+    framegenerator.h \
+    ../framedecoder.h \
+    ../framereassembler.h \
+    ../framescan.h \
+    ../sensorregistry.h
@@ -0,0 +1,215 @@
+#include "framegenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <chrono>
+#include <thread>
+
+#ifdef Q_OS_UNIX
+#  include <cerrno>
+#  include <csignal>
+#  include <cstring>
+#  include <fcntl.h>
+#  include <termios.h>
+#  include <unistd.h>
+#endif
+
+// Emits simulated engine frames on a pseudo-terminal so that the monitor
+// can be pointed at the slave side like at a real serial port.
+
+#ifdef Q_OS_UNIX
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+static bool writeAll(int fd, const quint8 *data, int size) {
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, size_t(size));
+        if (written < 0) {
+            if (errno == EINTR && !stopRequested)
+                continue;
+            return false;
+        }
+        data += written;
+        size -= int(written);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("framesim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Emits engine monitor frames on a pseudo-terminal.");
+    parser.addHelpOption();
+    QCommandLineOption rateOption({ "r", "rate" }, "Frames per second, 0 for as fast as the reader takes them, "
+                                                   "\"line\" for the line rate of --baud.", "fps", "100");
+    QCommandLineOption sensorsOption({ "s", "sensors" }, "Sensor blocks per frame, 1 to 30.", "count", "30");
+    QCommandLineOption profileOption({ "p", "profile" }, "Comma separated: ramp, noise, errors, corrupt, split.", "profiles", "ramp");
+    QCommandLineOption corruptOption("corrupt-rate", "Fraction of frames corrupted by the corrupt profile.", "fraction", "0.01");
+    QCommandLineOption baudOption({ "b", "baud" }, "Baud rate for --rate line, 11 bits per byte (8O1).", "baud", "115200");
+    QCommandLineOption durationOption({ "d", "duration" }, "Stop after this many seconds, 0 runs until interrupted.", "seconds", "0");
+    QCommandLineOption linkOption({ "l", "link" }, "Also make the slave reachable through this symlink.", "path");
+    QCommandLineOption seedOption("seed", "Random seed.", "seed", "1");
+    parser.addOptions({ rateOption, sensorsOption, profileOption, corruptOption, baudOption, durationOption, linkOption, seedOption });
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    int profiles = 0;
+    bool split = false;
+    bool garbage = false;
+    for (const QString &name : parser.value(profileOption).split(',', Qt::SkipEmptyParts)) {
+        const QString profile = name.trimmed();
+        if (profile == "ramp") {
+            profiles |= FrameGenerator::Ramp;
+        } else if (profile == "noise") {
+            profiles |= FrameGenerator::Noise;
+        } else if (profile == "errors") {
+            profiles |= FrameGenerator::ErrorFlags;
+        } else if (profile == "corrupt") {
+            profiles |= FrameGenerator::BadChecksum;
+            garbage = true;
+        } else if (profile == "split") {
+            split = true;
+        } else {
+            err << "Unknown profile " << profile << Qt::endl;
+            return 1;
+        }
+    }
+
+    const int sensors = parser.value(sensorsOption).toInt();
+    if (sensors < 1 || sensors > FrameReassembler::MaxSensors) {
+        err << "Sensor count must be between 1 and " << FrameReassembler::MaxSensors << Qt::endl;
+        return 1;
+    }
+
+    const bool lineRate = parser.value(rateOption) == "line";
+    const double rate = lineRate ? 0 : parser.value(rateOption).toDouble();
+    const double bytesPerSecond = parser.value(baudOption).toDouble() / 11;
+    const double duration = parser.value(durationOption).toDouble();
+
+    FrameGenerator generator(sensors, profiles, parser.value(seedOption).toUInt());
+    generator.setCorruptionRate(parser.value(corruptOption).toDouble());
+
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        err << "Cannot create a pseudo-terminal: " << strerror(errno) << Qt::endl;
+        return 1;
+    }
+    const QByteArray slaveName = ptsname(master);
+
+    // Raw mode on the slave, and keep it open so that writes do not fail
+    // while no reader is attached
+    const int slave = ::open(slaveName.constData(), O_RDWR | O_NOCTTY);
+    if (slave >= 0) {
+        termios attributes;
+        if (tcgetattr(slave, &attributes) == 0) {
+            cfmakeraw(&attributes);
+            tcsetattr(slave, TCSANOW, &attributes);
+        }
+    }
+
+    const QByteArray link = parser.value(linkOption).toLocal8Bit();
+    if (!link.isEmpty()) {
+        ::unlink(link.constData());
+        if (::symlink(slaveName.constData(), link.constData()) != 0)
+            err << "Cannot create link " << link << ": " << strerror(errno) << Qt::endl;
+    }
+
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    signal(SIGPIPE, SIG_IGN);
+
+    QTextStream(stdout) << slaveName << Qt::endl;
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+    Clock::time_point nextReport = start + std::chrono::seconds(1);
+    quint8 frame[FrameReassembler::MaxFrameSize];
+    quint8 noise[64];
+    qint64 frames = 0;
+    qint64 bytes = 0;
+    qint64 reportedFrames = 0;
+    qint64 reportedBytes = 0;
+
+    while (!stopRequested) {
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (duration > 0 && elapsed >= duration)
+            break;
+
+        // Pace against the start so that sleep overshoot does not accumulate
+        double dueSeconds = 0;
+        if (lineRate)
+            dueSeconds = bytes / bytesPerSecond;
+        else if (rate > 0)
+            dueSeconds = frames / rate;
+        if (dueSeconds > elapsed)
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dueSeconds)));
+
+        const int size = generator.next(dueSeconds > elapsed ? dueSeconds : elapsed, frame);
+
+        bool written = true;
+        if (garbage && generator.uniform() < 0.01) {
+            // Line noise between frames, with the odd header byte in it
+            const int length = 1 + int(generator.random() % sizeof(noise));
+            for (int i = 0; i < length; ++i)
+                noise[i] = (generator.random() & 3) == 0 ? 0xA5 : quint8(generator.random());
+            written = writeAll(master, noise, length);
+            bytes += length;
+        }
+
+        if (split) {
+            // Arbitrary chunks with a short gap, as a UART driver delivers them
+            int offset = 0;
+            while (written && offset < size) {
+                const int chunk = qMin(size - offset, 1 + int(generator.random() % 64));
+                written = writeAll(master, frame + offset, chunk);
+                offset += chunk;
+                if (offset < size)
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        } else if (written) {
+            written = writeAll(master, frame, size);
+        }
+        if (!written) {
+            if (!stopRequested)
+                err << "Write failed: " << strerror(errno) << Qt::endl;
+            break;
+        }
+        ++frames;
+        bytes += size;
+
+        const Clock::time_point now = Clock::now();
+        if (now >= nextReport) {
+            err << frames - reportedFrames << " frames/s, " << (bytes - reportedBytes) / 1024 << " KiB/s ("
+                << QString::number(100.0 * (bytes - reportedBytes) / bytesPerSecond, 'f', 0) << "% of line rate)" << Qt::endl;
+            reportedFrames = frames;
+            reportedBytes = bytes;
+            nextReport += std::chrono::seconds(1);
+        }
+    }
+
+    err << frames << " frames, " << bytes << " bytes sent" << Qt::endl;
+    if (!link.isEmpty())
+        ::unlink(link.constData());
+    if (slave >= 0)
+        ::close(slave);
+    ::close(master);
+    return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream(stderr) << "framesim needs POSIX pseudo-terminals" << Qt::endl;
+    return 1;
+}
+
+#endif // Q_OS_UNIX
@@ -0,0 +1,15 @@
+QT = core gui widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = gaugebench
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    ../qcgaugewidget.cpp
+
+HEADERS += \
+    ../qcgaugewidget.h
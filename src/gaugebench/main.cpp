@@ -0,0 +1,160 @@
+#include "qcgaugewidget.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QProcess>
+#include <QTextStream>
+
+// Renders gauges through the offscreen platform and reports what each item
+// and each whole frame costs, with and without the static layer cache.
+//
+// A device pixel ratio is fixed per process (QT_SCALE_FACTOR), so several
+// --dpr values are measured by running this program once per value.
+
+// Same item stack as MainWindow::createGauge()
+static QcGaugeWidget *createGauge(QcNeedleItem **needle) {
+    QcGaugeWidget *gauge = new QcGaugeWidget;
+    gauge->addBackground(99);
+    QcBackgroundItem *bkg1 = gauge->addBackground(92);
+    bkg1->clearrColors();
+    bkg1->addColor(0.1, Qt::black);
+    bkg1->addColor(1.0, Qt::white);
+
+    QcBackgroundItem *bkg2 = gauge->addBackground(88);
+    bkg2->clearrColors();
+    bkg2->addColor(0.1, Qt::gray);
+    bkg2->addColor(1.0, Qt::darkGray);
+
+    gauge->addArc(55);
+    gauge->addDegrees(65)->setValueRange(0, 1000);
+    gauge->addColorBand(50);
+    gauge->addValues(80)->setValueRange(0, 1000);
+    gauge->addLabel(70)->setText("Oil Pressure");
+    QcLabelItem *lab = gauge->addLabel(40);
+    lab->setText("0");
+    *needle = gauge->addNeedle(60);
+    (*needle)->setLabel(lab);
+    (*needle)->setColor(Qt::white);
+    (*needle)->setValueRange(0, 1000);
+    gauge->addBackground(7);
+    gauge->addGlass(88);
+    return gauge;
+}
+
+static double drawMicroseconds(QcItem *item, QImage &image, int iterations) {
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+        item->draw(&painter);
+    return timer.nsecsElapsed() / 1000.0 / iterations;
+}
+
+// A moving needle on every frame, as during acquisition
+static double frameMicroseconds(QcGaugeWidget *gauge, QcNeedleItem *needle, int iterations) {
+    needle->setCurrentValue(0);
+    gauge->repaint(); // builds the cache outside the measurement
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        needle->setCurrentValue(float(i % 1000));
+        gauge->repaint();
+    }
+    return timer.nsecsElapsed() / 1000.0 / iterations;
+}
+
+static int runPerDpr(const QStringList &ratios) {
+    int result = 0;
+    for (const QString &ratio : ratios) {
+        QStringList arguments;
+        const QStringList original = QCoreApplication::arguments().mid(1);
+        for (int i = 0; i < original.size(); ++i) {
+            if (original[i] == "--dpr")
+                ++i;
+            else if (!original[i].startsWith("--dpr="))
+                arguments << original[i];
+        }
+        arguments << "--dpr" << ratio;
+        result |= QProcess::execute(QCoreApplication::applicationFilePath(), arguments);
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    // The ratio has to be known before the application exists
+    QByteArray dpr = "1";
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--dpr") == 0 && i + 1 < argc)
+            dpr = argv[i + 1];
+        else if (qstrncmp(argv[i], "--dpr=", 6) == 0)
+            dpr = argv[i] + 6;
+    }
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    if (!dpr.contains(','))
+        qputenv("QT_SCALE_FACTOR", dpr);
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gaugebench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures gauge rendering on the offscreen platform.");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Comma separated gauge edge lengths in pixels.", "sizes", "150,250,400,600");
+    QCommandLineOption dprOption("dpr", "Comma separated device pixel ratios.", "ratios", "1");
+    QCommandLineOption iterationsOption("iterations", "Draws per measurement.", "count", "500");
+    parser.addOptions({ sizesOption, dprOption, iterationsOption });
+    parser.process(app);
+
+    if (dpr.contains(','))
+        return runPerDpr(parser.value(dprOption).split(',', Qt::SkipEmptyParts));
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    QTextStream out(stdout);
+
+    for (const QString &sizeText : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        const int size = sizeText.toInt();
+        if (size <= 0)
+            continue;
+
+        QcNeedleItem *needle;
+        QcGaugeWidget *gauge = createGauge(&needle);
+        gauge->resize(size, size);
+        gauge->show();
+        QCoreApplication::processEvents();
+
+        const qreal ratio = gauge->devicePixelRatioF();
+        out << "\n" << size << "x" << size << " at dpr " << ratio << "\n";
+
+        QImage image(QSize(size, size) * ratio, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(ratio);
+        image.fill(Qt::transparent);
+        double itemsTotal = 0;
+        for (QcItem *item : gauge->items()) {
+            const double us = drawMicroseconds(item, image, iterations);
+            itemsTotal += us;
+            out << "  " << QString(item->metaObject()->className()).leftJustified(20)
+                << (item->isDynamic() ? "dynamic " : "static  ")
+                << QString::number(us, 'f', 1).rightJustified(9) << " us\n";
+        }
+        out << "  " << QString("sum of items").leftJustified(28) << QString::number(itemsTotal, 'f', 1).rightJustified(9) << " us\n";
+
+        gauge->setStaticCacheEnabled(false);
+        const double uncached = frameMicroseconds(gauge, needle, iterations);
+        gauge->setStaticCacheEnabled(true);
+        const double cached = frameMicroseconds(gauge, needle, iterations);
+
+        out << "  " << QString("frame, uncached").leftJustified(28) << QString::number(uncached, 'f', 1).rightJustified(9) << " us\n";
+        out << "  " << QString("frame, cached").leftJustified(28) << QString::number(cached, 'f', 1).rightJustified(9) << " us  ("
+            << QString::number(uncached / cached, 'f', 1) << "x)\n";
+        out << "  gauges per 60 Hz frame: " << int(16667 / uncached) << " uncached, " << int(16667 / cached) << " cached\n";
+        out.flush();
+
+        delete gauge;
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+#include <limits>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (std::atomic<quint64> &bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    lowest.store(std::numeric_limits<qint64>::max(), std::memory_order_relaxed);
+    highest.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketFor(quint64 microseconds) {
+    if (microseconds < LinearBuckets)
+        return int(microseconds);
+    const int exponent = 63 - int(qCountLeadingZeroBits(microseconds)); // >= 4
+    const int mantissa = int(microseconds >> (exponent - 3)) & (SubBuckets - 1);
+    const int bucket = LinearBuckets + (exponent - 4) * SubBuckets + mantissa;
+    return bucket < BucketCount ? bucket : BucketCount - 1;
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < LinearBuckets)
+        return quint64(bucket) + 1;
+    const int exponent = (bucket - LinearBuckets) / SubBuckets + 4;
+    const int mantissa = (bucket - LinearBuckets) % SubBuckets;
+    return (quint64(SubBuckets + mantissa + 1) << (exponent - 3));
+}
+
+void LatencyHistogram::record(qint64 nanoseconds) {
+    if (nanoseconds < 0)
+        nanoseconds = 0;
+    buckets[bucketFor(quint64(nanoseconds) / 1000)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(quint64(nanoseconds), std::memory_order_relaxed);
+
+    qint64 current = lowest.load(std::memory_order_relaxed);
+    while (nanoseconds < current && !lowest.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed)) {
+    }
+    current = highest.load(std::memory_order_relaxed);
+    while (nanoseconds > current && !highest.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+qint64 LatencyHistogram::minimum() const {
+    return count() ? lowest.load(std::memory_order_relaxed) : 0;
+}
+
+qint64 LatencyHistogram::maximum() const {
+    return highest.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    const quint64 n = count();
+    return n ? double(sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+qint64 LatencyHistogram::percentile(double fraction) const {
+    const quint64 n = count();
+    if (n == 0)
+        return 0;
+    const quint64 rank = quint64(fraction * (n - 1)) + 1;
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return qMin(qint64(bucketUpperBound(i) * 1000), maximum());
+    }
+    return maximum();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+void LatencyStats::reset() {
+    arrivalToDecoded.reset();
+    decodedToStored.reset();
+    decodedToPainted.reset();
+}
+
+static QString histogramRow(const QString &name, const LatencyHistogram &histogram) {
+    const auto us = [](double ns) { return QString::number(ns / 1000.0, 'f', 1).rightJustified(10); };
+    return name.leftJustified(20) + QString::number(histogram.count()).rightJustified(10)
+           + us(histogram.minimum()) + us(histogram.mean())
+           + us(histogram.percentile(0.50)) + us(histogram.percentile(0.99))
+           + us(histogram.percentile(0.999)) + us(histogram.maximum()) + "\n";
+}
+
+QString LatencyStats::report() const {
+    QString text = QString("Stage").leftJustified(20) + QString("count").rightJustified(10)
+                   + QString("min us").rightJustified(10) + QString("mean us").rightJustified(10)
+                   + QString("p50 us").rightJustified(10) + QString("p99 us").rightJustified(10)
+                   + QString("p99.9 us").rightJustified(10) + QString("max us").rightJustified(10) + "\n";
+    text += histogramRow("arrival->decoded", arrivalToDecoded);
+    text += histogramRow("decoded->stored", decodedToStored);
+    text += histogramRow("decoded->painted", decodedToPainted);
+    return text;
+}
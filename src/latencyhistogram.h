@@ -0,0 +1,50 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QString>
+#include <atomic>
+
+// Log-linear latency histogram with microsecond resolution below 16 us and
+// eight sub-buckets per power of two above (at most 12.5% error). Recording
+// is wait-free, so it can sit on any thread's hot path; reads from another
+// thread give a consistent-enough snapshot for reporting.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(qint64 nanoseconds);
+    void reset();
+
+    quint64 count() const { return total.load(std::memory_order_relaxed); }
+    qint64 minimum() const; // nanoseconds
+    qint64 maximum() const;
+    double mean() const;
+    qint64 percentile(double fraction) const; // upper bound of the bucket, nanoseconds
+
+private:
+    static const int LinearBuckets = 16;
+    static const int SubBuckets = 8;
+    static const int BucketCount = LinearBuckets + 40 * SubBuckets;
+
+    static int bucketFor(quint64 microseconds);
+    static quint64 bucketUpperBound(int bucket);
+
+    std::atomic<quint64> buckets[BucketCount];
+    std::atomic<quint64> total;
+    std::atomic<quint64> sum;
+    std::atomic<qint64> lowest;
+    std::atomic<qint64> highest;
+};
+
+// Latency of every pipeline stage, measured from the monotonic timestamps
+// carried in DecodedFrame
+struct LatencyStats {
+    LatencyHistogram arrivalToDecoded;
+    LatencyHistogram decodedToStored;
+    LatencyHistogram decodedToPainted;
+
+    void reset();
+    QString report() const;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,136 @@
+#include "latestvaluesegment.h"
+#include "monotonicclock.h"
+#include <QDateTime>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#  include "emsshm.h"
+#  include <cerrno>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+LatestValueSegment::LatestValueSegment() : segment(nullptr), utcOffsetUs(0) {
+    memset(valueOf, 0, sizeof(valueOf));
+}
+
+LatestValueSegment::~LatestValueSegment() {
+    close();
+}
+
+QString LatestValueSegment::defaultName(quint8 source) {
+#ifdef Q_OS_UNIX
+    const QString name = QString::fromLatin1(EMS_SHM_NAME);
+    return source == 0 ? name : name + QString("_port%1").arg(source + 1);
+#else
+    Q_UNUSED(source);
+    return QString();
+#endif
+}
+
+bool LatestValueSegment::open(const QString &name, quint8 source, const SensorRegistry &registry) {
+    close();
+#ifdef Q_OS_UNIX
+    objectName = name.toLocal8Bit();
+    const int fd = shm_open(objectName.constData(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        error = QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+    void *address = MAP_FAILED;
+    if (ftruncate(fd, sizeof(ems_shm_segment)) == 0)
+        address = mmap(nullptr, sizeof(ems_shm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+        error = QString::fromLocal8Bit(strerror(errno));
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        shm_unlink(objectName.constData());
+        return false;
+    }
+
+    // Readers check the magic, so it is written last
+    segment = static_cast<ems_shm_segment *>(address);
+    memset(segment, 0, sizeof(ems_shm_segment));
+    const qint64 startNs = monotonicNanoseconds();
+    const qint64 startUtcUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    utcOffsetUs = startUtcUs - startNs / 1000;
+    ems_shm_header &header = segment->header;
+    header.version = EMS_SHM_VERSION;
+    header.header_size = sizeof(ems_shm_header);
+    header.sensor_size = sizeof(ems_shm_sensor);
+    header.sensor_count = EMS_SHM_SENSOR_COUNT;
+    header.source = source;
+    header.writer_pid = getpid();
+    header.start_monotonic_ns = startNs;
+    header.start_utc_us = startUtcUs;
+
+    memset(valueOf, 0, sizeof(valueOf));
+    for (int id = 0; id < SensorIdCount; ++id) {
+        const SensorDescriptor &sensor = registry[quint8(id)];
+        segment->sensors[id].id = quint8(id);
+        segment->sensors[id].kind = sensor.kind == SensorKind::Value ? EMS_SHM_VALUE
+                                    : sensor.kind == SensorKind::Status ? EMS_SHM_STATUS : EMS_SHM_UNUSED;
+        if (sensor.kind == SensorKind::Status)
+            valueOf[id] = sensor.pairedId;
+    }
+    __atomic_store_n(&header.magic, EMS_SHM_MAGIC, __ATOMIC_RELEASE);
+    error.clear();
+    return true;
+#else
+    Q_UNUSED(name);
+    Q_UNUSED(source);
+    Q_UNUSED(registry);
+    error = "Shared memory is only supported on Unix";
+    return false;
+#endif
+}
+
+void LatestValueSegment::close() {
+#ifdef Q_OS_UNIX
+    if (!segment)
+        return;
+    munmap(segment, sizeof(ems_shm_segment));
+    shm_unlink(objectName.constData());
+    segment = nullptr;
+#endif
+}
+
+void LatestValueSegment::write(const DecodedFrame &frame) {
+#ifdef Q_OS_UNIX
+    if (!segment)
+        return;
+
+    const qint64 utcUs = frame.arrivalNs / 1000 + utcOffsetUs;
+    for (int i = 0; i < frame.sensorCount; ++i) {
+        const SensorSample &sample = frame.samples[i];
+        ems_shm_sensor &record = segment->sensors[sample.id];
+
+        // Only this thread writes, so the sequence can be read plainly
+        const quint32 sequence = record.sequence;
+        __atomic_store_n(&record.sequence, sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        record.time_ns = frame.arrivalNs;
+        record.utc_us = utcUs;
+        record.value = sample.value;
+        record.raw_value = sample.rawValue;
+        record.factor = sample.factor;
+        ++record.updates;
+        __atomic_store_n(&record.sequence, sequence + 2, __ATOMIC_RELEASE);
+
+        // A status sample also sets the error flag of its value sensor
+        const quint8 valueId = valueOf[sample.id];
+        if (valueId != 0 && (sample.value == 0 || sample.value == 1)) {
+            ems_shm_sensor &valueRecord = segment->sensors[valueId];
+            const quint32 valueSequence = valueRecord.sequence;
+            __atomic_store_n(&valueRecord.sequence, valueSequence + 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            valueRecord.error = sample.value == 1;
+            __atomic_store_n(&valueRecord.sequence, valueSequence + 2, __ATOMIC_RELEASE);
+        }
+    }
+    __atomic_fetch_add(&segment->header.frames, 1, __ATOMIC_RELAXED);
+#else
+    Q_UNUSED(frame);
+#endif
+}
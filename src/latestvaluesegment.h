@@ -0,0 +1,41 @@
+#ifndef LATESTVALUESEGMENT_H
+#define LATESTVALUESEGMENT_H
+
+#include <QString>
+#include "framedecoder.h"
+#include "sensorregistry.h"
+
+struct ems_shm_segment;
+
+// Writer side of the latest-value shared memory segment (see emsshm.h).
+// write() runs on the acquisition thread: a few stores per sample under
+// each sensor's sequence lock, no system call and no waiting for readers.
+// Only available on Unix; open() fails elsewhere.
+class LatestValueSegment {
+public:
+    LatestValueSegment();
+    ~LatestValueSegment();
+
+    // EMS_SHM_NAME for source 0, with a _port<n> suffix for the others
+    static QString defaultName(quint8 source);
+
+    // Creates or takes over the POSIX shared memory object name and clears it
+    bool open(const QString &name, quint8 source, const SensorRegistry &registry);
+    // Unmaps and removes the object
+    void close();
+    bool isOpen() const { return segment != nullptr; }
+    QString errorString() const { return error; }
+
+    void write(const DecodedFrame &frame);
+
+private:
+    Q_DISABLE_COPY(LatestValueSegment)
+
+    ems_shm_segment *segment;
+    QByteArray objectName;
+    qint64 utcOffsetUs; // wall clock minus monotonic clock
+    quint8 valueOf[SensorIdCount]; // status ID -> value ID, 0 if none
+    QString error;
+};
+
+#endif // LATESTVALUESEGMENT_H
@@ -0,0 +1,145 @@
+#include "logwriter.h"
+#include "monotonicclock.h"
+#include "sensorregistry.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+LogWriter::LogWriter(QObject *parent)
+    : QObject(parent), drainTimer(new QTimer(this)), flushTimer(new QTimer(this)), latency(nullptr) {
+    csvLog.setBufferSize(BufferSize);
+    binaryLog.setBufferSize(BufferSize);
+    compressedLog.setBufferSize(BufferSize);
+    drainTimer->setInterval(DrainIntervalMs);
+    connect(drainTimer, &QTimer::timeout, this, &LogWriter::drain);
+    connect(flushTimer, &QTimer::timeout, this, &LogWriter::flush);
+}
+
+bool LogWriter::start(const QString &directory, Format format, int flushIntervalMs,
+                      const QVector<BinaryLogSensorDescriptor> &sensors) {
+    stop();
+
+    // Frames queued while no log was open belong to no run
+    DecodedFrame frame;
+    while (frames.pop(frame)) {
+    }
+    AlarmEvent event;
+    while (alarmEvents.pop(event)) {
+    }
+    while (spectrumAlarmEvents.pop(event)) {
+    }
+
+    bool opened;
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+    if (format == Binary) {
+        currentFile = QDir(directory).filePath("engine_data" + fileSuffix + "_" + stamp + ".emslog");
+        opened = binaryLog.open(currentFile, sensors);
+        error = binaryLog.errorString();
+    } else if (format == Compressed) {
+        currentFile = QDir(directory).filePath("engine_data" + fileSuffix + "_" + stamp + ".emsz");
+        opened = compressedLog.open(currentFile, sensors);
+        error = compressedLog.errorString();
+    } else {
+        currentFile = QDir(directory).filePath("engine_data" + fileSuffix + ".csv");
+        opened = csvLog.open(currentFile);
+        error = csvLog.errorString();
+    }
+    if (!opened) {
+        qWarning() << "Failed to open log" << currentFile << error;
+        return false;
+    }
+
+    const QFileInfo info(currentFile);
+    alarmLog.setFileName(info.dir().filePath(info.completeBaseName() + "_alarms.csv"));
+    if (alarmLog.open(QIODevice::WriteOnly | QIODevice::Text))
+        alarmLog.write("Time,Sensor ID,Sensor,Event,Severity,Cause,Value\n");
+    else
+        qWarning() << "Failed to open alarm log" << alarmLog.fileName() << alarmLog.errorString();
+
+    drainTimer->start();
+    flushTimer->start(flushIntervalMs);
+    return true;
+}
+
+void LogWriter::stop() {
+    drainTimer->stop();
+    flushTimer->stop();
+    drain();
+    csvLog.close();
+    binaryLog.close();
+    compressedLog.close();
+    alarmLog.close();
+}
+
+bool LogWriter::drainAlarms(AlarmEventQueue &queue) {
+    AlarmEvent event;
+    bool written = false;
+    while (queue.pop(event)) {
+        if (alarmLog.isOpen()) {
+            writeAlarm(event);
+            written = true;
+        }
+    }
+    return written;
+}
+
+void LogWriter::drain() {
+    const bool sensorAlarms = drainAlarms(alarmEvents);
+    const bool bandAlarms = drainAlarms(spectrumAlarmEvents);
+    if (sensorAlarms || bandAlarms)
+        alarmLog.flush();
+
+    DecodedFrame frame;
+    while (frames.pop(frame)) {
+        if (binaryLog.isOpen())
+            binaryLog.write(frame);
+        else if (compressedLog.isOpen())
+            compressedLog.write(frame);
+        else if (csvLog.isOpen())
+            csvLog.write(frame);
+        else
+            continue;
+
+        // Stored means handed to the log buffer; the disk write follows at
+        // the latest one flush interval later
+        if (latency)
+            latency->decodedToStored.record(monotonicNanoseconds() - frame.decodedNs);
+    }
+}
+
+void LogWriter::flush() {
+    drain();
+    if (binaryLog.isOpen())
+        binaryLog.flush();
+    if (compressedLog.isOpen()) {
+        compressedLog.sealExpired(monotonicNanoseconds());
+        compressedLog.flush();
+    }
+    if (csvLog.isOpen())
+        csvLog.flush();
+}
+
+void LogWriter::writeAlarm(const AlarmEvent &event) {
+    static const char *const types[] = { "Raised", "Reduced", "Cleared", "Acknowledged" };
+    static const char *const severities[] = { "Normal", "Warning", "Critical" };
+    static const char *const causes[] = { "", "Low", "High", "Rate" };
+
+    // Events carry monotonic time; the file gets wall-clock time
+    const qint64 ageMs = (monotonicNanoseconds() - event.timeNs) / 1000000;
+    const QString time = QDateTime::currentDateTime().addMSecs(-ageMs).toString(Qt::ISODateWithMs);
+    QString sensor = QString::fromUtf8(sensorRegistry()[event.id].name);
+    if (event.band != 0) {
+        const SpectrumBand &band = sensorRegistry().spectrumSettings().bands[event.band - 1];
+        sensor += QString(" %1-%2 Hz").arg(double(band.lowHz)).arg(double(band.highHz));
+    }
+    const QString line = QString("%1,0x%2,%3,%4,%5,%6,%7\n")
+                             .arg(time)
+                             .arg(event.id, 2, 16, QChar('0'))
+                             .arg(sensor)
+                             .arg(QLatin1String(types[event.type]))
+                             .arg(QLatin1String(severities[int(event.severity)]))
+                             .arg(QLatin1String(causes[int(event.cause)]))
+                             .arg(double(event.value));
+    alarmLog.write(line.toUtf8());
+}
@@ -0,0 +1,67 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+#include "acquisitionworker.h"
+#include "binarylog.h"
+#include "compressedlog.h"
+#include "csvlog.h"
+#include "latencyhistogram.h"
+
+// Owns the run log on a background thread. Decoded frames arrive through
+// queue(), are formatted into a large in-memory buffer and reach the disk in
+// big writes, at the latest every flush interval. The file stays open from
+// start() to stop(). Alarm events from alarmQueue() go to a CSV file next to
+// the log and are flushed as soon as they are drained.
+class LogWriter : public QObject {
+    Q_OBJECT
+public:
+    enum Format { Csv, Binary, Compressed };
+
+    explicit LogWriter(QObject *parent = nullptr);
+
+    // Must be called on the writer's thread
+    bool start(const QString &directory, Format format, int flushIntervalMs,
+               const QVector<BinaryLogSensorDescriptor> &sensors);
+    void stop();
+
+    // Appended to the log base name, for more than one source. Set before start().
+    void setFileSuffix(const QString &suffix) { fileSuffix = suffix; }
+    QString fileName() const { return currentFile; }
+    QString errorString() const { return error; }
+
+    DecodedFrameQueue &queue() { return frames; }
+    AlarmEventQueue &alarmQueue() { return alarmEvents; }
+    // Band alarms, from the spectrum thread
+    AlarmEventQueue &spectrumAlarmQueue() { return spectrumAlarmEvents; }
+    void setLatencyStats(LatencyStats *stats) { latency = stats; }
+
+private slots:
+    void drain();
+    void flush();
+
+private:
+    static const int BufferSize = 256 * 1024;
+    static const int DrainIntervalMs = 20;
+
+    bool drainAlarms(AlarmEventQueue &queue);
+    void writeAlarm(const AlarmEvent &event);
+
+    DecodedFrameQueue frames;
+    AlarmEventQueue alarmEvents;
+    AlarmEventQueue spectrumAlarmEvents;
+    QFile alarmLog;
+    QTimer *drainTimer;
+    QTimer *flushTimer;
+    CsvLogWriter csvLog;
+    BinaryLogWriter binaryLog;
+    CompressedLogWriter compressedLog;
+    LatencyStats *latency;
+    QString fileSuffix;
+    QString currentFile;
+    QString error;
+};
+
+#endif // LOGWRITER_H
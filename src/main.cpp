@@ -1,17 +1,244 @@
 #include "mainwindow.h"
-#include "serialhandler.h"
+#include "sensorregistry.h"
+#include "acquisitionpool.h"
+#include "spectrumworker.h"
+#include "telemetrypublisher.h"
 
 #include <QApplication>
-#include <QSerialPortInfo>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <csignal>
 
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+static void loadSensorRegistry() {
+    // Extra channels can be described next to the executable
+    const QString sensorFile = QDir(QCoreApplication::applicationDirPath()).filePath("sensors.json");
+    QString error;
+    if (QFile::exists(sensorFile) && !sensorRegistry().loadJson(sensorFile, &error))
+        qWarning() << "Ignoring" << sensorFile << error;
+}
+
+// Acquisition and logging only: no widgets, no display queue. Serial reads
+// and decoding run on a thread per port, file writes on the log thread.
+static int runHeadless(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("Engine Monitoring System");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Records engine sensor data without a user interface.");
+    parser.addHelpOption();
+    QCommandLineOption headlessOption("headless", "Run without the user interface.");
+    QCommandLineOption portOption({ "p", "port" }, "Serial port name; repeat for up to 8 ports.", "port");
+    QCommandLineOption baudOption({ "b", "baud" }, "Baud rate.", "baud", "115200");
+    QCommandLineOption parityOption("parity", "none, odd, even, mark or space.", "parity", "odd");
+    QCommandLineOption stopBitsOption("stop-bits", "1, 1.5 or 2.", "bits", "1");
+    QCommandLineOption outputOption({ "o", "output" }, "Log directory.", "directory", ".");
+    QCommandLineOption formatOption({ "f", "format" }, "csv, binary or compressed.", "format", "csv");
+    QCommandLineOption flushOption("flush-interval", "Longest time logged data stays in memory, ms.", "ms", "1000");
+    QCommandLineOption statsOption("stats", "Print a status line every this many seconds, 0 for none.", "seconds", "10");
+    QCommandLineOption publishOption("publish", "Also publish decoded values as UDP datagrams to address:port, a numeric unicast or multicast address.", "destination");
+    QCommandLineOption publishIntervalOption("publish-interval", "Longest time a value waits for its datagram, ms.", "ms", "20");
+    QCommandLineOption publishTtlOption("publish-ttl", "Multicast hops.", "hops", "1");
+    parser.addOptions({ headlessOption, portOption, baudOption, parityOption, stopBitsOption, outputOption,
+                        formatOption, flushOption, statsOption, publishOption, publishIntervalOption, publishTtlOption });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    if (!parser.isSet(portOption)) {
+        err << "--port is required in headless mode" << Qt::endl;
+        return 1;
+    }
+    const QStringList portNames = parser.values(portOption);
+    if (portNames.size() > AcquisitionPool::MaxSources) {
+        err << "At most " << AcquisitionPool::MaxSources << " ports can be recorded" << Qt::endl;
+        return 1;
+    }
+
+    const QString parityText = parser.value(parityOption).toLower();
+    QSerialPort::Parity parity = QSerialPort::NoParity;
+    if (parityText == "odd") {
+        parity = QSerialPort::OddParity;
+    } else if (parityText == "even") {
+        parity = QSerialPort::EvenParity;
+    } else if (parityText == "mark") {
+        parity = QSerialPort::MarkParity;
+    } else if (parityText == "space") {
+        parity = QSerialPort::SpaceParity;
+    } else if (parityText != "none") {
+        err << "Unknown parity " << parser.value(parityOption) << Qt::endl;
+        return 1;
+    }
+
+    const QString stopBitsText = parser.value(stopBitsOption);
+    QSerialPort::StopBits stopBits = QSerialPort::OneStop;
+    if (stopBitsText == "1.5") {
+        stopBits = QSerialPort::OneAndHalfStop;
+    } else if (stopBitsText == "2") {
+        stopBits = QSerialPort::TwoStop;
+    } else if (stopBitsText != "1") {
+        err << "Unknown stop bits " << stopBitsText << Qt::endl;
+        return 1;
+    }
+
+    const QString formatText = parser.value(formatOption).toLower();
+    LogWriter::Format format = LogWriter::Csv;
+    if (formatText == "binary") {
+        format = LogWriter::Binary;
+    } else if (formatText == "compressed") {
+        format = LogWriter::Compressed;
+    } else if (formatText != "csv") {
+        err << "Unknown format " << parser.value(formatOption) << Qt::endl;
+        return 1;
+    }
+
+    TelemetrySettings telemetrySettings;
+    telemetrySettings.intervalMs = qBound(1, parser.value(publishIntervalOption).toInt(), 60000);
+    telemetrySettings.ttl = qBound(1, parser.value(publishTtlOption).toInt(), 255);
+    QString destinationError;
+    if (parser.isSet(publishOption) && !parseTelemetryDestination(parser.value(publishOption), telemetrySettings, &destinationError)) {
+        err << "--publish " << parser.value(publishOption) << ": " << destinationError << Qt::endl;
+        return 1;
+    }
+
+    loadSensorRegistry();
+
+    LatencyStats latency;
+    AcquisitionPool pool(&latency);
+    for (int i = 0; i < portNames.size(); ++i)
+        pool.addSource();
+
+    // Band alarms of the spectrum analysis are logged as well
+    QThread spectrumThread;
+    SpectrumWorker *spectrumWorker = new SpectrumWorker(sensorRegistry().spectrumSettings());
+    spectrumWorker->setDisplayQueueEnabled(false);
+    spectrumWorker->setAlarmLogQueue(&pool.logWriter(0)->spectrumAlarmQueue());
+    spectrumWorker->moveToThread(&spectrumThread);
+    QObject::connect(&spectrumThread, &QThread::finished, spectrumWorker, &QObject::deleteLater);
+    spectrumThread.start();
+    QMetaObject::invokeMethod(spectrumWorker, [spectrumWorker]() { spectrumWorker->start(); });
+
+    // Decoded values go out over UDP as well when asked to
+    QThread telemetryThread;
+    TelemetryPublisher *telemetry = new TelemetryPublisher(portNames.size());
+    telemetry->moveToThread(&telemetryThread);
+    QObject::connect(&telemetryThread, &QThread::finished, telemetry, &QObject::deleteLater);
+    telemetryThread.start();
+    bool publishing = false;
+    if (parser.isSet(publishOption))
+        QMetaObject::invokeMethod(telemetry, [&]() { publishing = telemetry->start(telemetrySettings); }, Qt::BlockingQueuedConnection);
+
+    pool.worker(0)->setSpectrumQueue(&spectrumWorker->queue(), spectrumWorker->sensorId());
+    for (int i = 0; i < portNames.size() && publishing; ++i)
+        pool.worker(i)->setTelemetryQueue(&telemetry->queue(i));
+    pool.start();
+
+    const QString directory = parser.value(outputOption);
+    const int flushInterval = qMax(100, parser.value(flushOption).toInt());
+    const QVector<BinaryLogSensorDescriptor> sensors = binaryLogSensors(sensorRegistry());
+    const qint32 baudRate = parser.value(baudOption).toInt();
+
+    int result = 0;
+    if (parser.isSet(publishOption) && !publishing) {
+        err << "Cannot publish to " << parser.value(publishOption) << ": " << telemetry->errorString() << Qt::endl;
+        result = 1;
+    } else if (publishing) {
+        err << "Publishing to " << parser.value(publishOption) << Qt::endl;
+    }
+    for (int i = 0; i < portNames.size() && result == 0; ++i) {
+        LogWriter *logWriter = pool.logWriter(i);
+        AcquisitionWorker *worker = pool.worker(i);
+        bool logging = false;
+        QMetaObject::invokeMethod(logWriter, [&]() { logging = logWriter->start(directory, format, flushInterval, sensors); },
+                                  Qt::BlockingQueuedConnection);
+        bool opened = false;
+        if (logging)
+            QMetaObject::invokeMethod(worker, [&]() { opened = worker->openSerialPort(portNames[i], baudRate, parity, stopBits); },
+                                      Qt::BlockingQueuedConnection);
+        if (!logging)
+            err << "Cannot open log in " << directory << Qt::endl;
+        else if (opened)
+            err << "Recording " << portNames[i] << " to " << logWriter->fileName() << Qt::endl;
+        if (!opened)
+            result = 1;
+    }
+
+    if (result == 0) {
+
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        QTimer stopTimer;
+        QObject::connect(&stopTimer, &QTimer::timeout, &app, [&]() {
+            if (stopRequested)
+                app.quit();
+        });
+        stopTimer.start(200);
+
+        QTimer statsTimer;
+        quint64 reportedFrames = 0;
+        QObject::connect(&statsTimer, &QTimer::timeout, &app, [&]() {
+            const quint64 frames = latency.arrivalToDecoded.count();
+            quint64 dropped = 0;
+            for (int i = 0; i < pool.sourceCount(); ++i)
+                dropped += pool.worker(i)->droppedLogFrames();
+            err << frames << " frames (" << (frames - reportedFrames) * 1000 / quint64(statsTimer.interval())
+                << "/s), " << dropped << " dropped before logging";
+            if (publishing)
+                err << ", " << telemetry->sentDatagrams() << " datagrams published";
+            err << Qt::endl;
+            reportedFrames = frames;
+        });
+        const int statsSeconds = parser.value(statsOption).toInt();
+        if (statsSeconds > 0)
+            statsTimer.start(statsSeconds * 1000);
+
+        app.exec();
+        pool.closeAll();
+
+        // The workers are idle once their ports are closed
+        QVector<SensorStatistics> summary;
+        for (int i = 0; i < pool.sourceCount(); ++i)
+            summary += pool.worker(i)->statisticsSummary();
+        QString error;
+        const QString statisticsFile = QDir(directory).filePath("run_statistics.csv");
+        if (writeStatisticsCsv(statisticsFile, summary, sensorRegistry(), &error))
+            err << "Statistics written to " << statisticsFile << Qt::endl;
+        else
+            err << "Cannot write " << statisticsFile << ": " << error << Qt::endl;
+    }
+
+    QMetaObject::invokeMethod(spectrumWorker, [&]() { spectrumWorker->stop(); }, Qt::BlockingQueuedConnection);
+    spectrumThread.quit();
+    spectrumThread.wait();
+    pool.closeAll();
+    pool.stopLogs();
+    QMetaObject::invokeMethod(telemetry, [&]() { telemetry->stop(); }, Qt::BlockingQueuedConnection);
+    telemetryThread.quit();
+    telemetryThread.wait();
+    if (result == 0)
+        err << latency.report() << Qt::endl;
+    return result;
+}
 
 int main(int argc, char *argv[]) {
-    QApplication a(argc, argv);
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--headless") == 0)
+            return runHeadless(argc, argv);
+    }
 
-    SerialHandler handler;
+    QApplication a(argc, argv);
+    loadSensorRegistry();
 
     MainWindow w;
     w.show();
     return a.exec();
 }
-
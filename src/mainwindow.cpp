@@ -1,7 +1,6 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-#include <QFile>
-#include <QTextStream>
+#include "monotonicclock.h"
 #include <QMainWindow>
 #include <QtQuickWidgets/QtQuickWidgets>
 #include <QQmlEngine>
@@ -9,84 +8,168 @@
 #include <QDebug>
 #include <QTimer>
 #include <QFileDialog>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <cstring>
 
-static quint8 msgCounter = 0;
-static QString filePath = "engine_data.csv";
-
-QStringList dataFields =
-    {
-        "Oil Pressure",
-        "Oil Temp",
-        "Fuel Flow",
-        "Fuel",
-        "EGT",
-        "Torque",
-        "Indicated Power",
-        "Friction Power",
-        "Therm Efficiency",
-        "Air-Fuel Ratio",
-        "Motor Speed",
-        "Output Air Speed",
-        "Vibration",
-        "Body Temp",
-        "Air Temp",
-};
-
-QStringList sensorFields =
-    {
-        "Oil Pressure Sensor",
-        "Oil Temp Sensor",
-        "Fuel Flow Sensor",
-        "Fuel Sensor",
-        "EGT Sensor",
-        "Torque Sensor",
-        "Indicated Power Sensor",
-        "Friction Power Sensor",
-        "Therm Efficiency Sensor",
-        "Air-Fuel Ratio Sensor",
-        "Motor Speed Sensor",
-        "Output Air Speed Sensor",
-        "Vibration Sensor",
-        "Body Temp Sensor",
-        "Air Temp Sensor",
-};
-
-quint16 calculateChecksum(const QByteArray &data)
-{
-    quint16 sum = 0;
-    for (char byte : data)
-    {
-        sum += static_cast<quint8>(byte);
-    }
-    return sum;
-}
+static QString logDirectory = ".";
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow), handler(new SerialHandler(this))
+    : QMainWindow(parent), ui(new Ui::MainWindow), pool(&latency), worker(nullptr), activeSources(1), displaySource(0), spectrumWorker(new SpectrumWorker(sensorRegistry().spectrumSettings())), telemetry(new TelemetryPublisher(AcquisitionPool::MaxSources)), publishing(false), displayedFrameNs(0), registry(sensorRegistry())
 {
+    memset(snapshot, 0, sizeof(snapshot));
     ui->setupUi(this);
 
     // Set up gauges
     setupGauges();
+    setupTables();
+    history[0].setChannels(registry.valueIds());
+    setupTrend();
 
     on_portComboBox_activated(1);
 
-    connect(&serialHandler, &SerialHandler::dataReceived, this, &MainWindow::handleData);
-
-    // Set up timer for periodic data handling
-    QTimer *timer = new QTimer(this);
-    timer->start(1000); // 1 second interval
-    connect(timer, &QTimer::timeout, this, &MainWindow::processData);
+    // Serial reads and decoding run on a thread per source, logging on a
+    // shared log thread fed straight from acquisition. More sources are
+    // added when a run needs them.
+    addSource();
+    worker = pool.worker(0);
+
+    // Spectrum analysis runs on its own thread, fed with one sensor's samples
+    setupSpectrum();
+    worker->setSpectrumQueue(&spectrumWorker->queue(), spectrumWorker->sensorId());
+    spectrumWorker->setAlarmLogQueue(&pool.logWriter(0)->spectrumAlarmQueue());
+    spectrumWorker->moveToThread(&spectrumThread);
+    connect(&spectrumThread, &QThread::finished, spectrumWorker, &QObject::deleteLater);
+    spectrumThread.start();
+    QMetaObject::invokeMethod(spectrumWorker, [this]() { spectrumWorker->start(); });
+    pool.start();
+
+    // Telemetry datagrams are batched and sent on their own thread
+    telemetry->moveToThread(&telemetryThread);
+    connect(&telemetryThread, &QThread::finished, telemetry, &QObject::deleteLater);
+    telemetryThread.start();
+
+    // The display is refreshed on a render tick, independent of the frame rate
+    renderTimer.setTimerType(Qt::PreciseTimer);
+    connect(&renderTimer, &QTimer::timeout, this, &MainWindow::processData);
+    on_renderRateComboBox_currentIndexChanged(ui->renderRateComboBox->currentIndex());
+
+    QTimer *diagnosticsTimer = new QTimer(this);
+    diagnosticsTimer->start(1000);
+    connect(diagnosticsTimer, &QTimer::timeout, this, &MainWindow::updateDiagnostics);
 }
 
 MainWindow::~MainWindow()
 {
+    pool.closeAll();
+    QMetaObject::invokeMethod(spectrumWorker, [this]() { spectrumWorker->stop(); }, Qt::BlockingQueuedConnection);
+    spectrumThread.quit();
+    spectrumThread.wait();
+    stopTelemetry();
+    telemetryThread.quit();
+    telemetryThread.wait();
+    pool.stopLogs();
+    writeLatencyReport();
     delete ui;
 }
 
+int MainWindow::addSource()
+{
+    const int source = pool.addSource();
+    if (source < 0)
+        return -1;
+    pool.worker(source)->setDisplayQueueEnabled(true);
+
+    // Alarms are shown as soon as the frame that raised them is decoded,
+    // without waiting for the render tick
+    connect(pool.worker(source), &AcquisitionWorker::alarmsChanged, this, &MainWindow::processAlarms);
+
+    // Every further source gets its own block of table rows
+    if (source > 0)
+    {
+        for (quint8 id : registry.valueIds())
+        {
+            const SensorDescriptor &sensor = registry[id];
+            const QString name = QString("Port %1 %2").arg(source + 1).arg(QString::fromUtf8(sensor.name));
+            dataModel->addSensor(name, sensor.minValue, sensor.maxValue);
+            statusModel->addSensor(name, sensor.minValue, sensor.maxValue);
+        }
+        ui->displaySourceComboBox->addItem(QString("Port %1").arg(source + 1));
+    }
+    return source;
+}
+
+int MainWindow::tableRow(int source, quint8 id) const
+{
+    return source * registry.rowCount() + registry[id].tableRow;
+}
+
+bool MainWindow::prepareSources(int count)
+{
+    // Latency is reported per run, like the run statistics
+    pool.closeAll();
+    latency.reset();
+    while (pool.sourceCount() < count && addSource() >= 0)
+    {
+    }
+    pool.start();
+    if (count > pool.sourceCount())
+        return false;
+
+    // The sources are closed, so their telemetry queues can be switched
+    for (int source = 0; source < pool.sourceCount(); ++source)
+        pool.worker(source)->setTelemetryQueue(publishing ? &telemetry->queue(source) : nullptr);
+    return true;
+}
+
+bool MainWindow::openSources(const QStringList &portNames, qint32 baudRate, QSerialPort::Parity parity, QSerialPort::StopBits stopBits)
+{
+    for (int source = 0; source < portNames.size(); ++source)
+    {
+        AcquisitionWorker *sourceWorker = pool.worker(source);
+        const QString portName = portNames[source];
+        bool opened = false;
+        QMetaObject::invokeMethod(sourceWorker, [&]() { opened = sourceWorker->openSerialPort(portName, baudRate, parity, stopBits); },
+                                  Qt::BlockingQueuedConnection);
+        if (!opened)
+        {
+            pool.closeAll();
+            return false;
+        }
+    }
+    return true;
+}
+
+void MainWindow::resetRun(int sources)
+{
+    // The sources of a run share the history budget
+    activeSources = sources;
+    for (int source = 0; source < AcquisitionPool::MaxSources; ++source)
+    {
+        history[source].setMemoryBudget(SensorHistory::DefaultBudget / sources);
+        history[source].setChannels(source < sources ? registry.valueIds() : QVector<quint8>());
+    }
+    memset(snapshot, 0, sizeof(snapshot));
+    if (displaySource >= sources)
+        ui->displaySourceComboBox->setCurrentIndex(0);
+    trend->setHistory(&history[displaySource]);
+
+    dataModel->clearAlarms();
+    dataModel->clearStatistics();
+    dataModel->commit();
+    QMetaObject::invokeMethod(spectrumWorker, [this]() { spectrumWorker->start(); });
+}
+
 void MainWindow::on_startButton_clicked()
 {
-    QString portName = ui->portComboBox->currentText();
+    // The additional ports use the same serial settings
+    QStringList portNames(ui->portComboBox->currentText());
+    for (const QString &name : ui->extraPortsLineEdit->text().split(',', Qt::SkipEmptyParts))
+    {
+        if (!name.trimmed().isEmpty())
+            portNames.append(name.trimmed());
+    }
     int baudRate = ui->baudRateComboBox->currentText().toInt();
 
     QString parityText = ui->parityComboBox->currentText();
@@ -109,22 +192,86 @@ void MainWindow::on_startButton_clicked()
     else if (stopBitText == "2")
         stopBit = QSerialPort::TwoStop;
 
-    if (serialHandler.openSerialPort(portName, baudRate, parity, stopBit))
-        ui->statusLabel->setText("Status: Connected");
+    // The logs are open before the ports, so the first frames are stored too
+    const bool telemetryStarted = startTelemetry();
+    bool opened = prepareSources(portNames.size());
+    const bool logging = opened && startLogging(portNames.size());
+    opened = opened && openSources(portNames, baudRate, parity, stopBit);
+    if (opened)
+    {
+        resetRun(portNames.size());
+        ui->statusLabel->setText(portNames.size() > 1 ? QString("Status: Connected to %1 ports").arg(portNames.size()) : QString("Status: Connected"));
+    }
     else
+    {
+        pool.stopLogs();
+        stopTelemetry();
         ui->statusLabel->setText("Status: Failed to connect");
+    }
+
+    if (opened && !logging)
+        ui->statusLabel->setText("Status: Connected, logging failed");
+    else if (opened && !telemetryStarted)
+        ui->statusLabel->setText("Status: Connected, publishing failed");
 }
 
-void MainWindow::on_stopButton_clicked()
+bool MainWindow::startLogging(int sources)
 {
-    serialHandler.closeSerialPort();
-    ui->statusLabel->setText("Disconnected");
+    const QString formatText = ui->logFormatComboBox->currentText();
+    LogWriter::Format format = LogWriter::Csv;
+    if (formatText == "Binary")
+        format = LogWriter::Binary;
+    else if (formatText == "Compressed")
+        format = LogWriter::Compressed;
+    int flushInterval = ui->flushIntervalSpinBox->value();
+    const QVector<BinaryLogSensorDescriptor> sensors = binaryLogSensors(registry);
+    bool allLogging = true;
+    for (int source = 0; source < sources; ++source)
+    {
+        LogWriter *logWriter = pool.logWriter(source);
+        bool logging = false;
+        QMetaObject::invokeMethod(logWriter, [&]() { logging = logWriter->start(logDirectory, format, flushInterval, sensors); },
+                                  Qt::BlockingQueuedConnection);
+        allLogging = allLogging && logging;
+    }
+    return allLogging;
+}
+
+bool MainWindow::startTelemetry()
+{
+    // Takes effect when the sources are next opened
+    stopTelemetry();
+    const QString destination = ui->publishLineEdit->text().trimmed();
+    if (destination.isEmpty())
+        return true;
+
+    TelemetrySettings settings;
+    settings.intervalMs = ui->publishIntervalSpinBox->value();
+    settings.ttl = 1;
+    QString error;
+    if (!parseTelemetryDestination(destination, settings, &error))
+    {
+        qWarning() << "Cannot publish to" << destination << error;
+        return false;
+    }
+    QMetaObject::invokeMethod(telemetry, [&]() { publishing = telemetry->start(settings); }, Qt::BlockingQueuedConnection);
+    return publishing;
+}
+
+void MainWindow::stopTelemetry()
+{
+    // Sends what is still batched
+    QMetaObject::invokeMethod(telemetry, [this]() { telemetry->stop(); }, Qt::BlockingQueuedConnection);
+    publishing = false;
 }
 
-void MainWindow::handleData(const QByteArray &data)
+void MainWindow::on_stopButton_clicked()
 {
-    // Store the received data
-    receivedData = data;
+    pool.closeAll();
+    pool.stopLogs();
+    stopTelemetry();
+    showRunStatistics();
+    ui->statusLabel->setText("Disconnected");
 }
 
 void MainWindow::on_selectDirectoryButton_clicked()
@@ -133,417 +280,321 @@ void MainWindow::on_selectDirectoryButton_clicked()
                                                           QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
     if (!directory.isEmpty())
     {
-        filePath = directory + "/engine_data.csv";
+        logDirectory = directory;
         ui->directoryLabel->setText(directory);
     }
 }
 
+void MainWindow::on_replayOpenButton_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open Recorded Session"), logDirectory, tr("Binary logs (*.emslog)"));
+    if (fileName.isEmpty())
+        return;
+
+    // A replay is a single source
+    pool.closeAll();
+    latency.reset();
+    const bool telemetryStarted = startTelemetry();
+    worker->setTelemetryQueue(publishing ? &telemetry->queue(0) : nullptr);
+    bool opened = false;
+    QMetaObject::invokeMethod(worker, [&]() { opened = worker->openReplay(fileName); }, Qt::BlockingQueuedConnection);
+    if (!opened)
+    {
+        stopTelemetry();
+        ui->statusLabel->setText("Status: Failed to open replay");
+        return;
+    }
+
+    // A replay is stored like a live run, so it exercises the whole pipeline
+    resetRun(1);
+    ui->replayFileLabel->setText(QFileInfo(fileName).fileName());
+    ui->replaySlider->setRange(0, int(qMax<qint64>(0, worker->replay()->recordCount() - 1)));
+    ui->replaySlider->setValue(0);
+    if (!startLogging(1))
+        ui->statusLabel->setText("Status: Replaying, logging failed");
+    else
+        ui->statusLabel->setText(telemetryStarted ? "Status: Replaying" : "Status: Replaying, publishing failed");
+    on_replaySpeedComboBox_currentIndexChanged(ui->replaySpeedComboBox->currentIndex());
+    QMetaObject::invokeMethod(worker, [this]() { worker->replay()->play(); });
+}
+
+void MainWindow::on_replayPlayButton_clicked()
+{
+    QMetaObject::invokeMethod(worker, [this]()
+                              {
+                                  ReplaySource *replay = worker->replay();
+                                  if (replay->isPlaying())
+                                      replay->pause();
+                                  else
+                                      replay->play();
+                              });
+}
+
+void MainWindow::on_replayStopButton_clicked()
+{
+    QMetaObject::invokeMethod(worker, [this]() { worker->closeReplay(); }, Qt::BlockingQueuedConnection);
+    pool.stopLogs();
+    stopTelemetry();
+    showRunStatistics();
+    ui->replayFileLabel->clear();
+    ui->replayPositionLabel->clear();
+    ui->statusLabel->setText("Disconnected");
+}
+
+void MainWindow::on_replaySpeedComboBox_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    // "Max" does not parse and means as fast as possible
+    QString text = ui->replaySpeedComboBox->currentText();
+    text.chop(1);
+    double speed = text.toDouble();
+    QMetaObject::invokeMethod(worker, [this, speed]() { worker->replay()->setSpeed(speed); });
+}
+
+void MainWindow::on_replaySlider_sliderReleased()
+{
+    qint64 record = ui->replaySlider->value();
+    QMetaObject::invokeMethod(worker, [this, record]() { worker->seekReplay(record); });
+}
+
+void MainWindow::updateReplayPosition()
+{
+    const ReplaySource *replay = worker->replay();
+    const qint64 count = replay->recordCount();
+    if (count == 0)
+        return;
+    const qint64 position = replay->position();
+    if (!ui->replaySlider->isSliderDown())
+        ui->replaySlider->setValue(int(qMin(position, count - 1)));
+    const char *state = replay->isPlaying() ? "" : position >= count ? " (finished)" : " (paused)";
+    ui->replayPositionLabel->setText(QString("Record %1 / %2%3").arg(position).arg(count).arg(state));
+}
+
+void MainWindow::on_renderRateComboBox_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    int rate = ui->renderRateComboBox->currentText().toInt();
+    if (rate <= 0)
+        rate = 30;
+    renderTimer.start(1000 / rate);
+}
+
 void MainWindow::processData()
 {
-    if (!receivedData.isEmpty())
+    // Drain everything the acquisition threads decoded since the last tick.
+    // Every sample goes into its source's history, the display gets the
+    // newest one.
+    DecodedFrame frame;
+    for (int source = 0; source < pool.sourceCount(); ++source)
     {
-        parseMessage(receivedData);
-        saveDataToCSV("engine_data.csv", receivedData);
-        receivedData.clear(); // Clear the buffer
+        while (pool.worker(source)->queue().pop(frame))
+        {
+            SensorHistory &sourceHistory = history[frame.source];
+            SensorSnapshot *sourceSnapshot = snapshot[frame.source];
+            for (int i = 0; i < frame.sensorCount; ++i)
+            {
+                const SensorSample &sample = frame.samples[i];
+                sourceHistory.append(sample.id, frame.arrivalNs, float(sample.value));
+                SensorSnapshot &latest = sourceSnapshot[sample.id];
+                latest.value = sample.value;
+                latest.decodedNs = frame.decodedNs;
+                latest.changed = true;
+            }
+        }
     }
+
+    // Gauges and tables are touched at most once per sensor per tick
+    for (int source = 0; source < pool.sourceCount(); ++source)
+    {
+        for (int id = 0; id < SensorIdCount; ++id)
+        {
+            SensorSnapshot &latest = snapshot[source][id];
+            if (!latest.changed)
+                continue;
+            latest.changed = false;
+            displayedFrameNs = latest.decodedNs;
+            updateDisplay(source, id, latest.value);
+        }
+    }
+    dataModel->commit();
+    statusModel->commit();
+    updateReplayPosition();
+
+    // Only the newest spectrum is shown
+    bool newSpectrum = false;
+    while (spectrumWorker->spectra().pop(spectrum))
+        newSpectrum = true;
+    if (newSpectrum && spectrumView->isVisible())
+        spectrumView->setSpectrum(spectrum);
+
+    // The trend only draws the columns that elapsed since the last tick
+    if (trend->isVisible())
+        trend->advance(monotonicNanoseconds());
 }
 
-void MainWindow::saveDataToCSV(const QString &fileName, const QByteArray &data)
+void MainWindow::processAlarms()
 {
-    QFile file(fileName);
-    if (!file.open(QIODevice::Append | QIODevice::Text))
+    AlarmEvent event;
+    for (int source = 0; source < pool.sourceCount(); ++source)
     {
-        qDebug() << "Failed to open file for writing";
-        return;
+        while (pool.worker(source)->alarmQueue().pop(event))
+            dataModel->setAlarm(tableRow(source, event.id), event.severity, event.acknowledged);
     }
+    dataModel->commit();
+}
 
-    QTextStream out(&file);
-    int dataSize = data.size();
-    QByteArray unpackedData = data.mid(4, dataSize - 7);
-    for (int i = 4; i < dataSize - 3; i += 10)
+void MainWindow::on_acknowledgeButton_clicked()
+{
+    for (int source = 0; source < pool.sourceCount(); ++source)
     {
-        std::reverse(unpackedData.begin() + i, unpackedData.begin() + i + 4);
-        std::reverse(unpackedData.begin() + i + 4, unpackedData.begin() + i + 8);
+        AcquisitionWorker *sourceWorker = pool.worker(source);
+        QMetaObject::invokeMethod(sourceWorker, [sourceWorker]() { sourceWorker->acknowledgeAlarm(0); });
     }
+    QMetaObject::invokeMethod(spectrumWorker, [this]() { spectrumWorker->acknowledgeAlarms(); });
+}
 
-    quint8 idNumber = unpackedData[1];
-    out << QString::number(idNumber);
-    for (int i = 2; i < 10 * idNumber; i += 10)
+void MainWindow::setGaugeValue(QcNeedleItem *needle, double value)
+{
+    needle->setCurrentValue(value);
+    paintPending[static_cast<QcGaugeWidget *>(needle->parent())] = displayedFrameNs;
+}
+
+void MainWindow::updateDiagnostics()
+{
+    QString text = latency.report();
+    text += "\n";
+    qint64 historyMemory = 0;
+    for (int source = 0; source < pool.sourceCount(); ++source)
     {
-        QByteArray valueBytes = unpackedData.mid(i + 2, 4);
-        std::reverse(valueBytes.begin(), valueBytes.end());
-        quint32 value = *reinterpret_cast<const quint32 *>(valueBytes.data());
-        QByteArray factorBytes = unpackedData.mid(i + 6, 4);
-        std::reverse(factorBytes.begin(), factorBytes.end());
-        quint32 factor = *reinterpret_cast<const quint32 *>(factorBytes.data());
-        double realValue = factor == 0 ? value : static_cast<double>(value) / factor;
-        out << "," << QString::number(realValue, 'f', 1);
+        const AcquisitionWorker *sourceWorker = pool.worker(source);
+        text += QString("Port %1 frames dropped before display: %2, before logging: %3, before publishing: %4\n")
+                    .arg(source + 1)
+                    .arg(sourceWorker->droppedFrames())
+                    .arg(sourceWorker->droppedLogFrames())
+                    .arg(sourceWorker->droppedTelemetryFrames());
+        historyMemory += history[source].memoryUsage();
     }
-    out << "\n";
-    file.close();
+    text += QString("History memory: %1 MiB\n").arg(historyMemory / (1024 * 1024));
+    text += QString("Telemetry datagrams sent: %1, failed: %2\n").arg(telemetry->sentDatagrams()).arg(telemetry->failedDatagrams());
+    ui->diagnosticsText->setPlainText(text);
 }
 
-void MainWindow::parseMessage(const QByteArray &data)
+void MainWindow::writeLatencyReport()
 {
-    int dataSize = data.size();
-    if (dataSize % 10 != 9 || dataSize > 309)
-        return; // Ensure true message length
+    const QString report = latency.report();
+    qInfo().noquote() << "Latency report\n" << report;
 
-    // Check header and footer
-    QByteArray checkSum = data.mid(dataSize - 3, 2);
-    std::reverse(checkSum.begin(), checkSum.end());
-    QByteArray unpackedData = data.mid(4, dataSize - 7);
-    for (int i = 4; i < dataSize - 3; i += 10)
+    QFile file(QDir(logDirectory).filePath("latency_report.txt"));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text))
+        file.write(report.toUtf8());
+}
+
+void MainWindow::showRunStatistics()
+{
+    // Kept up to date by the workers, so this is only a copy
+    QVector<SensorStatistics> summary;
+    for (int source = 0; source < activeSources; ++source)
     {
-        std::reverse(unpackedData.begin() + i, unpackedData.begin() + i + 4);
-        std::reverse(unpackedData.begin() + i + 4, unpackedData.begin() + i + 8);
+        AcquisitionWorker *sourceWorker = pool.worker(source);
+        QMetaObject::invokeMethod(sourceWorker, [&]() { summary += sourceWorker->statisticsSummary(); }, Qt::BlockingQueuedConnection);
     }
-    if (data.left(4) == QByteArray::fromHex("A5A5A5A5") && data.right(1) == QByteArray::fromHex("55") && qFromBigEndian<quint16>(checkSum.constData()) == calculateChecksum(unpackedData))
+    for (const SensorStatistics &sensor : summary)
+        dataModel->setStatistics(tableRow(sensor.source, sensor.id), sensor);
+    dataModel->commit();
+
+    QString error;
+    const QString fileName = QDir(logDirectory).filePath("run_statistics.csv");
+    if (!writeStatisticsCsv(fileName, summary, registry, &error))
+        qWarning() << "Failed to write" << fileName << error;
+}
+
+void MainWindow::updateDisplay(int source, int id, double value)
+{
+    const SensorDescriptor &sensor = registry[quint8(id)];
+    if (sensor.kind == SensorKind::Status)
     {
-        if (msgCounter == unpackedData[0])
-            return;
-        msgCounter = unpackedData[0];
-        quint8 idNumber = unpackedData[1];
-        for (int i = 2; i < 10 * idNumber; i += 10)
-        {
-            quint8 id = unpackedData[i];
-            QByteArray valueBytes = unpackedData.mid(i + 2, 4);
-            std::reverse(valueBytes.begin(), valueBytes.end());
-            quint32 value = *reinterpret_cast<const quint32 *>(valueBytes.data());
-            QByteArray factorBytes = unpackedData.mid(i + 6, 4);
-            std::reverse(factorBytes.begin(), factorBytes.end());
-            quint32 factor = *reinterpret_cast<const quint32 *>(factorBytes.data());
-            double realValue = factor == 0 ? value : static_cast<double>(value) / factor;
-            updateDisplay(id, QString::number(realValue, 'f', 1).toDouble()); // Update specific gauges based on ID
-        }
+        if (value == 0 || value == 1)
+            statusModel->setError(tableRow(source, quint8(id)), value == 1);
+        return;
     }
+
+    if (sensor.kind != SensorKind::Value)
+        return;
+
+    // Out-of-range values are alarms; the table shows them, the gauge cannot
+    if (source == displaySource && sensor.gauge != NoGauge && value >= sensor.minValue && value <= sensor.maxValue)
+        setGaugeValue(needles[sensor.gauge], value);
+    dataModel->setValue(tableRow(source, quint8(id)), value);
 }
 
-void MainWindow::updateDisplay(int id, double value)
+void MainWindow::on_displaySourceComboBox_currentIndexChanged(int index)
 {
-    QTableWidgetItem *dataItem = new QTableWidgetItem(QString::number(value));
-    dataItem->setData(Qt::UserRole, QVariant::fromValue(dataItem));
-    QTableWidgetItem *sensorItem = new QTableWidgetItem();
-    sensorItem->setData(Qt::UserRole, QVariant::fromValue(sensorItem));
-    switch (id)
+    displaySource = qBound(0, index, AcquisitionPool::MaxSources - 1);
+    trend->setHistory(&history[displaySource]);
+
+    // Bring the gauges over to the new source's latest values
+    for (SensorSnapshot &latest : snapshot[displaySource])
     {
-    case 0x01:
-        if (value >= 0 && value <= 1000)
-        {
-            oilPressureNeedle->setCurrentValue(value);
-            ui->dataTable->setItem(0, 3, dataItem);
-        }
-        break;
-    case 0x02:
-        if (value >= 0 && value <= 400)
-        {
-            oilTempNeedle->setCurrentValue(value);
-            ui->dataTable->setItem(1, 3, dataItem);
-        }
-        break;
-    case 0x03:
-        if (value >= 0 && value <= 800)
-        {
-            ui->dataTable->setItem(2, 3, dataItem);
-        }
-        break;
-    case 0x04:
-        if (value >= 0 && value <= 800)
-        {
-            fuelNeedle->setCurrentValue(value);
-            ui->dataTable->setItem(3, 3, dataItem);
-        }
-        break;
-    case 0x05:
-        if (value >= 0 && value <= 400)
-        {
-            ui->dataTable->setItem(4, 3, dataItem);
-        }
-        break;
-    case 0x06:
-        if (value >= 0 && value <= 400)
-        {
-            torqueNeedle->setCurrentValue(value);
-            ui->dataTable->setItem(5, 3, dataItem);
-        }
-        break;
-    case 0x07:
-        if (value >= 0 && value <= 400)
-        {
-            ui->dataTable->setItem(6, 3, dataItem);
-        }
-        break;
-    case 0x08:
-        if (value >= 0 && value <= 400)
-        {
-            ui->dataTable->setItem(7, 3, dataItem);
-        }
-        break;
-    case 0x09:
-        if (value >= 0 && value <= 100)
-        {
-            ui->dataTable->setItem(8, 3, dataItem);
-        }
-        break;
-    case 0x0A:
-        if (value >= 0 && value <= 20)
-        {
-            ui->dataTable->setItem(9, 3, dataItem);
-        }
-        break;
-    case 0x0B:
-        if (value >= 0 && value <= 1000)
-        {
-            motorSpeedNeedle->setCurrentValue(value);
-            ui->dataTable->setItem(10, 3, dataItem);
-        }
-        break;
-    case 0x0C:
-        if (value >= 0 && value <= 1000)
-        {
-            ui->dataTable->setItem(11, 3, dataItem);
-        }
-        break;
-    case 0x0D:
-        if (value >= 0 && value <= 100)
-        {
-            vibrationNeedle->setCurrentValue(value);
-            ui->dataTable->setItem(12, 3, dataItem);
-        }
-        break;
-    case 0x0E:
-        if (value >= 0 && value <= 400)
-        {
-            ui->dataTable->setItem(13, 3, dataItem);
-        }
-        break;
-    case 0x0F:
-        if (value >= 0 && value <= 400)
-        {
-            ui->dataTable->setItem(14, 3, dataItem);
-        }
-        break;
-    case 0x11:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(0, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(0, 1, sensorItem);
-        }
-        break;
-    case 0x12:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(1, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(1, 1, sensorItem);
-        }
-        break;
-    case 0x13:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(2, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(2, 1, sensorItem);
-        }
-        break;
-    case 0x14:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(3, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(3, 1, sensorItem);
-        }
-        break;
-    case 0x15:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(4, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(4, 1, sensorItem);
-        }
-        break;
-    case 0x16:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(5, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(5, 1, sensorItem);
-        }
-        break;
-    case 0x17:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(6, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(6, 1, sensorItem);
-        }
-        break;
-    case 0x18:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(7, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(7, 1, sensorItem);
-        }
-        break;
-    case 0x19:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(8, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(8, 1, sensorItem);
-        }
-        break;
-    case 0x1A:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(9, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(9, 1, sensorItem);
-        }
-        break;
-    case 0x1B:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(10, 20, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(10, 1, sensorItem);
-        }
-        break;
-    case 0x1C:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(11, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(11, 1, sensorItem);
-        }
-        break;
-    case 0x1D:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(12, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(12, 1, sensorItem);
-        }
-        break;
-    case 0x1E:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(13, 1, sensorItem);
-        }
-        else if (value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(13, 1, sensorItem);
-        }
-        break;
-    case 0x1F:
-        if (value == 1)
-        {
-            sensorItem->setText("ERROR");
-            sensorItem->setBackground(QBrush(Qt::red));
-            ui->sensorTable->setItem(14, 1, sensorItem);
-        }
-        else if(value == 0)
-        {
-            sensorItem->setText("OK");
-            sensorItem->setBackground(QBrush(Qt::green));
-            ui->sensorTable->setItem(14, 1, sensorItem);
-        }
-        break;
+        if (latest.decodedNs != 0)
+            latest.changed = true;
+    }
+}
+
+void MainWindow::setupTables()
+{
+    dataModel = new SensorTableModel(SensorTableModel::Values, this);
+    statusModel = new SensorTableModel(SensorTableModel::Status, this);
+    for (quint8 id : registry.valueIds())
+    {
+        const SensorDescriptor &sensor = registry[id];
+        dataModel->addSensor(QString::fromUtf8(sensor.name), sensor.minValue, sensor.maxValue);
+        statusModel->addSensor(QString::fromUtf8(sensor.name), sensor.minValue, sensor.maxValue);
+    }
+    ui->dataTable->setModel(dataModel);
+    ui->sensorTable->setModel(statusModel);
+}
+
+void MainWindow::setupTrend()
+{
+    trend = new TrendWidget(this);
+    trend->setHistory(&history[displaySource]);
+    const QVector<quint8> ids = registry.valueIds();
+    for (int i = 0; i < ids.size(); ++i)
+    {
+        const SensorDescriptor &sensor = registry[ids[i]];
+        trend->addChannel(sensor.id, QString::fromUtf8(sensor.name), sensor.minValue, sensor.maxValue,
+                          QColor::fromHsv(i * 360 / ids.size(), 200, 240));
     }
+    ui->trendLayout->addWidget(trend);
+}
+
+void MainWindow::setupSpectrum()
+{
+    spectrumView = new SpectrumView(this);
+    const SpectrumSettings &settings = spectrumWorker->spectrumSettings();
+    spectrumView->setSettings(settings, QString::fromUtf8(registry[settings.id].name));
+    ui->spectrumLayout->addWidget(spectrumView);
 }
 
 void MainWindow::setupGauges()
 {
-    oilPressureNeedle = createGauge(oilPressureNeedle, "Oil Pressure", ui->oilPressureLayout, 0, 1000);
-    oilTempNeedle = createGauge(oilTempNeedle, "Oil Temp", ui->oilTempLayout, 0, 400);
-    fuelNeedle = createGauge(fuelNeedle, "Fuel", ui->fuelLayout, 0, 800);
-    torqueNeedle = createGauge(torqueNeedle, "Torque", ui->torqueLayout, 0, 400);
-    motorSpeedNeedle = createGauge(motorSpeedNeedle, "Motor Speed", ui->motorSpeedLayout, 0, 1000);
-    vibrationNeedle = createGauge(vibrationNeedle, "Vibration", ui->vibrationLayout, 0, 100);
+    QLayout *layouts[GaugeCount] =
+        {
+            ui->oilPressureLayout,
+            ui->oilTempLayout,
+            ui->fuelLayout,
+            ui->torqueLayout,
+            ui->motorSpeedLayout,
+            ui->vibrationLayout,
+        };
+
+    memset(needles, 0, sizeof(needles));
+    for (quint8 id : registry.valueIds())
+    {
+        const SensorDescriptor &sensor = registry[id];
+        if (sensor.gauge != NoGauge)
+            needles[sensor.gauge] = createGauge(QString::fromUtf8(sensor.name), layouts[sensor.gauge], sensor.minValue, sensor.maxValue);
+    }
 }
 
 
@@ -560,7 +611,7 @@ void MainWindow::on_portComboBox_activated(int index)
     }
 }
 
-QcNeedleItem *MainWindow::createGauge(QcNeedleItem *needle, const QString &title, QLayout *layout, int minValue, int maxValue)
+QcNeedleItem *MainWindow::createGauge(const QString &title, QLayout *layout, int minValue, int maxValue)
 {
     QcGaugeWidget *gauge = new QcGaugeWidget;
     gauge->addBackground(99);
@@ -583,7 +634,7 @@ QcNeedleItem *MainWindow::createGauge(QcNeedleItem *needle, const QString &title
     gauge->addLabel(70)->setText(title);
     QcLabelItem *lab = gauge->addLabel(40);
     lab->setText("0");
-    needle = gauge->addNeedle(60);
+    QcNeedleItem *needle = gauge->addNeedle(60);
     needle->setLabel(lab);
     needle->setColor(Qt::white);
     needle->setValueRange(minValue, maxValue);
@@ -591,5 +642,12 @@ QcNeedleItem *MainWindow::createGauge(QcNeedleItem *needle, const QString &title
     gauge->addGlass(88);
     layout->addWidget(gauge);
 
+    connect(gauge, &QcGaugeWidget::painted, this, [this, gauge]()
+            {
+                const qint64 decodedNs = paintPending.take(gauge);
+                if (decodedNs != 0)
+                    latency.decodedToPainted.record(monotonicNanoseconds() - decodedNs);
+            });
+
     return needle;
 }
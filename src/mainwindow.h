@@ -3,10 +3,18 @@
 
 #include <QMainWindow>
 #include <QQuickWidget>
-#include <QTableWidget>
 #include <QTimer>
-#include "serialhandler.h"
+#include <QThread>
+#include "acquisitionpool.h"
+#include "latencyhistogram.h"
 #include "qcgaugewidget.h"
+#include "sensortablemodel.h"
+#include "sensorregistry.h"
+#include "sensorhistory.h"
+#include "trendwidget.h"
+#include "spectrumworker.h"
+#include "spectrumview.h"
+#include "telemetrypublisher.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -23,34 +31,86 @@ public:
 private slots:
     void on_startButton_clicked();
     void on_stopButton_clicked();
-    void handleData(const QByteArray &data);
     void processData();
+    void processAlarms();
 
     void on_portComboBox_activated(int index);
 
     void on_selectDirectoryButton_clicked();
 
+    void updateDiagnostics();
+
+    void on_renderRateComboBox_currentIndexChanged(int index);
+
+    void on_replayOpenButton_clicked();
+    void on_replayPlayButton_clicked();
+    void on_replayStopButton_clicked();
+    void on_replaySpeedComboBox_currentIndexChanged(int index);
+    void on_replaySlider_sliderReleased();
+
+    void on_acknowledgeButton_clicked();
+
+    void on_displaySourceComboBox_currentIndexChanged(int index);
+
 private:
     Ui::MainWindow *ui;
-    SerialHandler serialHandler;
+    LatencyStats latency;
 
-    SerialHandler *handler;
+    // One source per serial port; source 0 also plays replays and feeds the
+    // spectrum analysis
+    AcquisitionPool pool;
+    AcquisitionWorker *worker;
+    int activeSources;
+    int displaySource;
 
-    QByteArray receivedData;
+    QThread spectrumThread;
+    SpectrumWorker *spectrumWorker;
+    SpectrumView *spectrumView;
+    Spectrum spectrum;
 
-    QcNeedleItem *oilPressureNeedle;
-    QcNeedleItem *oilTempNeedle;
-    QcNeedleItem *fuelNeedle;
-    QcNeedleItem *torqueNeedle;
-    QcNeedleItem *motorSpeedNeedle;
-    QcNeedleItem *vibrationNeedle;
+    QThread telemetryThread;
+    TelemetryPublisher *telemetry;
+    bool publishing;
 
-    QcNeedleItem *createGauge(QcNeedleItem *needle, const QString &title, QLayout *layout, int minValue, int maxValue);
+    qint64 displayedFrameNs;
 
-    void parseMessage(const QByteArray &data);
-    void updateDisplay(int id, double value);
-    void setupGauges();
+    // Latest value per sensor ID, collected from the queue at full rate and
+    // shown once per render tick
+    struct SensorSnapshot
+    {
+        double value;
+        qint64 decodedNs;
+        bool changed;
+    };
+    SensorSnapshot snapshot[AcquisitionPool::MaxSources][SensorIdCount];
+    SensorHistory history[AcquisitionPool::MaxSources];
+    TrendWidget *trend;
+    QTimer renderTimer;
+    SensorTableModel *dataModel;
+    SensorTableModel *statusModel;
+    QHash<QcGaugeWidget *, qint64> paintPending;
+
+    const SensorRegistry &registry;
+    QcNeedleItem *needles[GaugeCount];
 
-    void saveDataToCSV(const QString &fileName, const QByteArray &data);
+    QcNeedleItem *createGauge(const QString &title, QLayout *layout, int minValue, int maxValue);
+
+    int addSource();
+    bool prepareSources(int count);
+    bool openSources(const QStringList &portNames, qint32 baudRate, QSerialPort::Parity parity, QSerialPort::StopBits stopBits);
+    void resetRun(int sources);
+    int tableRow(int source, quint8 id) const;
+    void updateDisplay(int source, int id, double value);
+    void setGaugeValue(QcNeedleItem *needle, double value);
+    void writeLatencyReport();
+    void showRunStatistics();
+    void setupGauges();
+    void setupTables();
+    void setupTrend();
+    void setupSpectrum();
+    bool startLogging(int sources);
+    bool startTelemetry();
+    void stopTelemetry();
+    void updateReplayPosition();
 };
 #endif // MAINWINDOW_H
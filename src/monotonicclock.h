@@ -0,0 +1,14 @@
+#ifndef MONOTONICCLOCK_H
+#define MONOTONICCLOCK_H
+
+#include <QtGlobal>
+#include <chrono>
+
+// Nanoseconds on the steady clock. Every timestamp in the acquisition
+// pipeline uses this so that values from different threads compare directly.
+inline qint64 monotonicNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // MONOTONICCLOCK_H
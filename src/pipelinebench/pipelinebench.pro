@@ -0,0 +1,44 @@
+QT = core gui testlib
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = pipelinebench
+
+# Benchmarks the monitor's own sources
+INCLUDEPATH += .. ../framesim
+
+SOURCES += \
+    tst_pipelinebench.cpp \
+    ../framesim/framegenerator.cpp \
+    ../alarmengine.cpp \
+    ../framedecoder.cpp \
+    ../framereassembler.cpp \
+    ../framescan.cpp \
+    ../binarylog.cpp \
+    ../compressedlog.cpp \
+    ../timeseriescodec.cpp \
+    ../csvlog.cpp \
+    ../sensorregistry.cpp \
+    ../runstatistics.cpp \
+    ../sensortablemodel.cpp \
+    ../spectrumanalyzer.cpp \
+    ../telemetrypacket.cpp
+
+HEADERS += \
+    ../framesim/framegenerator.h \
+    ../alarmengine.h \
+    ../framedecoder.h \
+    ../framereassembler.h \
+    ../framescan.h \
+    ../binarylog.h \
+    ../compressedlog.h \
+    ../timeseriescodec.h \
+    ../csvlog.h \
+    ../monotonicclock.h \
+    ../sensorregistry.h \
+    ../runstatistics.h \
+    ../sensortablemodel.h \
+    ../spectrumanalyzer.h \
+    ../spscqueue.h \
+    ../telemetrypacket.h
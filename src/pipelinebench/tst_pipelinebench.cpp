@@ -0,0 +1,399 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "framegenerator.h"
+#include "alarmengine.h"
+#include "runstatistics.h"
+#include "telemetrypacket.h"
+#include "spectrumanalyzer.h"
+#include "framedecoder.h"
+#include "framereassembler.h"
+#include "framescan.h"
+#include "binarylog.h"
+#include "compressedlog.h"
+#include "csvlog.h"
+#include "monotonicclock.h"
+#include "sensorregistry.h"
+#include "sensortablemodel.h"
+#include "spscqueue.h"
+
+// Every allocation in the process is counted, so a stage that allocates per
+// frame shows up as allocs/frame > 0 next to its timing.
+static std::atomic<quint64> allocationCount(0);
+
+void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const int CorpusFrames = 1000;
+
+struct Corpus {
+    QByteArray stream;                  // frames back to back, as read from the port
+    QVector<int> offsets;
+    QVector<int> sizes;
+    QVector<DecodedFrame> decoded;
+};
+
+Corpus makeCorpus(int sensorCount) {
+    Corpus corpus;
+    FrameGenerator generator(sensorCount, FrameGenerator::Ramp | FrameGenerator::Noise);
+    quint8 frame[FrameReassembler::MaxFrameSize];
+    for (int i = 0; i < CorpusFrames; ++i) {
+        const int size = generator.next(i * 0.01, frame);
+        corpus.offsets.append(corpus.stream.size());
+        corpus.sizes.append(size);
+        corpus.stream.append(reinterpret_cast<const char *>(frame), size);
+
+        DecodedFrame decoded;
+        decodeFrame(frame, size, decoded);
+        decoded.arrivalNs = decoded.decodedNs = monotonicNanoseconds();
+        corpus.decoded.append(decoded);
+    }
+    return corpus;
+}
+
+// Accumulates over all QBENCHMARK iterations and prints the per-frame view
+class StageMeter {
+public:
+    StageMeter() : frames(0), allocations(allocationCount.load()) { timer.start(); }
+    void add(int count) { frames += count; }
+    ~StageMeter() {
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        const quint64 allocated = allocationCount.load() - allocations;
+        if (frames == 0)
+            return;
+        qInfo("%-24s %10.1f ns/frame %12.0f frames/s %8.3f allocs/frame",
+              QTest::currentDataTag(), double(elapsedNs) / frames, frames * 1e9 / elapsedNs, double(allocated) / frames);
+    }
+
+private:
+    QElapsedTimer timer;
+    qint64 frames;
+    quint64 allocations;
+};
+
+} // namespace
+
+class PipelineBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void checksum_data() { corpusRows(); }
+    void checksum();
+    void reassemble_data() { corpusRows(); }
+    void reassemble();
+    void decode_data() { corpusRows(); }
+    void decode();
+    void alarms_data() { corpusRows(); }
+    void alarms();
+    void statistics_data() { corpusRows(); }
+    void statistics();
+    void spectrum_data() { corpusRows(); }
+    void spectrum();
+    void queue_data() { corpusRows(); }
+    void queue();
+    void csvLog_data() { corpusRows(); }
+    void csvLog();
+    void binaryLog_data() { corpusRows(); }
+    void binaryLog();
+    void compressedLog_data() { corpusRows(); }
+    void compressedLog();
+    void telemetry_data() { corpusRows(); }
+    void telemetry();
+    void displayUpdate_data() { corpusRows(); }
+    void displayUpdate();
+
+private:
+    void corpusRows();
+    const Corpus &corpus();
+
+    Corpus corpora[3];
+    QTemporaryDir directory;
+};
+
+void PipelineBench::initTestCase() {
+    QVERIFY(directory.isValid());
+    corpora[0] = makeCorpus(1);
+    corpora[1] = makeCorpus(15);
+    corpora[2] = makeCorpus(30);
+    qInfo("Scan kernel: %s, spectrum kernel: %s", frameScanKernel(), SpectrumAnalyzer::kernel());
+}
+
+void PipelineBench::corpusRows() {
+    QTest::addColumn<int>("corpusIndex");
+    QTest::newRow("1 sensor") << 0;
+    QTest::newRow("15 sensors") << 1;
+    QTest::newRow("30 sensors") << 2;
+}
+
+const Corpus &PipelineBench::corpus() {
+    QFETCH(int, corpusIndex);
+    return corpora[corpusIndex];
+}
+
+void PipelineBench::checksum() {
+    const Corpus &data = corpus();
+    const quint8 *stream = reinterpret_cast<const quint8 *>(data.stream.constData());
+    quint32 sink = 0;
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i) {
+            const quint8 *frame = stream + data.offsets[i];
+            sink += frameChecksum(frame + FrameReassembler::HeaderSize, data.sizes[i] - FrameReassembler::HeaderSize - 3);
+        }
+        meter.add(CorpusFrames);
+    }
+    QVERIFY(sink != 0);
+}
+
+void PipelineBench::reassemble() {
+    const Corpus &data = corpus();
+    FrameReassembler reassembler;
+    int found = 0;
+    StageMeter meter;
+    QBENCHMARK {
+        reassembler.reset();
+        found = 0;
+        // Fed in serial-read sized chunks
+        for (int offset = 0; offset < data.stream.size(); offset += 1024) {
+            reassembler.append(data.stream.constData() + offset, qMin(1024, data.stream.size() - offset));
+            while (reassembler.nextFrame() > 0)
+                ++found;
+        }
+        meter.add(CorpusFrames);
+    }
+    QCOMPARE(found, CorpusFrames);
+}
+
+void PipelineBench::decode() {
+    const Corpus &data = corpus();
+    const quint8 *stream = reinterpret_cast<const quint8 *>(data.stream.constData());
+    DecodedFrame decoded;
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i)
+            decodeFrame(stream + data.offsets[i], data.sizes[i], decoded);
+        meter.add(CorpusFrames);
+    }
+    QCOMPARE(int(decoded.counter), int(data.decoded.last().counter));
+}
+
+// Limit, hysteresis and rate checks on every sample of every frame
+void PipelineBench::alarms() {
+    const Corpus &data = corpus();
+    AlarmEngine engine;
+    engine.configure(sensorRegistry());
+    AlarmEvent event;
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i) {
+            const DecodedFrame &frame = data.decoded[i];
+            for (int s = 0; s < frame.sensorCount; ++s)
+                engine.evaluate(frame.samples[s].id, frame.arrivalNs, float(frame.samples[s].value), event);
+        }
+        meter.add(CorpusFrames);
+    }
+}
+
+// Welford moments and three P² quantiles on every sample
+void PipelineBench::statistics() {
+    const Corpus &data = corpus();
+    RunStatistics statistics;
+    statistics.setChannels(sensorRegistry().valueIds());
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i) {
+            const DecodedFrame &frame = data.decoded[i];
+            for (int s = 0; s < frame.sensorCount; ++s)
+                statistics.add(frame.samples[s].id, frame.samples[s].value);
+        }
+        meter.add(CorpusFrames);
+    }
+}
+
+// Vibration samples through the sliding FFT, as on the spectrum thread
+void PipelineBench::spectrum() {
+    const Corpus &data = corpus();
+    const SpectrumSettings &settings = sensorRegistry().spectrumSettings();
+    SpectrumAnalyzer analyzer(settings.size, qMax(1, int(SpectrumAnalyzer::roundedSize(settings.size) * (1 - settings.overlap))));
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i) {
+            const DecodedFrame &frame = data.decoded[i];
+            for (int s = 0; s < frame.sensorCount; ++s) {
+                if (frame.samples[s].id == settings.id)
+                    analyzer.push(qint64(i) * 1000000, float(frame.samples[s].value));
+            }
+        }
+        meter.add(CorpusFrames);
+    }
+}
+
+// Hand-off from the acquisition thread to the GUI and log threads
+void PipelineBench::queue() {
+    const Corpus &data = corpus();
+    static SpscQueue<DecodedFrame, 4096> frames;
+    DecodedFrame frame;
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i)
+            frames.push(data.decoded[i]);
+        while (frames.pop(frame)) {
+        }
+        meter.add(CorpusFrames);
+    }
+}
+
+void PipelineBench::csvLog() {
+    const Corpus &data = corpus();
+    CsvLogWriter writer;
+    writer.setBufferSize(256 * 1024);
+    QVERIFY(writer.open(directory.filePath("bench.csv")));
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i)
+            writer.write(data.decoded[i]);
+        meter.add(CorpusFrames);
+    }
+    QVERIFY(writer.flush());
+}
+
+void PipelineBench::binaryLog() {
+    const Corpus &data = corpus();
+    const SensorRegistry registry;
+    BinaryLogWriter writer;
+    writer.setBufferSize(256 * 1024);
+    QVERIFY(writer.open(directory.filePath("bench.emslog"), binaryLogSensors(registry)));
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i)
+            writer.write(data.decoded[i]);
+        meter.add(CorpusFrames);
+    }
+    QVERIFY(writer.flush());
+}
+
+// Frames are restamped at the generator's 10 ms period, so every
+// iteration continues the series instead of jumping back in time
+void PipelineBench::compressedLog() {
+    const Corpus &data = corpus();
+    const SensorRegistry registry;
+    const QVector<BinaryLogSensorDescriptor> sensors = binaryLogSensors(registry);
+    CompressedLogWriter writer;
+    writer.setBufferSize(256 * 1024);
+    QVERIFY(writer.open(directory.filePath("bench.emsz"), sensors));
+    const qint64 headerSize = writer.size();
+    const qint64 periodNs = 10000000;
+    qint64 frames = 0;
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i) {
+            DecodedFrame frame = data.decoded[i];
+            frame.arrivalNs = frames++ * periodNs;
+            writer.write(frame);
+        }
+        meter.add(CorpusFrames);
+    }
+    writer.close();
+    const double recordSize = binaryLogRecordSize(sensors.size());
+    const double bytesPerFrame = double(writer.size() - headerSize) / frames;
+    qInfo("%-24s %10.1f bytes/frame, binary log %.0f", QTest::currentDataTag(), bytesPerFrame, recordSize);
+}
+
+// Datagram packing on the telemetry thread, without the socket
+void PipelineBench::telemetry() {
+    const Corpus &data = corpus();
+    TelemetryPacketWriter packet;
+    quint32 sequence = 0;
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i) {
+            const DecodedFrame &frame = data.decoded[i];
+            for (int s = 0; s < frame.sensorCount; ++s) {
+                if (packet.sampleCount() == 0)
+                    packet.begin(sequence, frame.arrivalNs, 0);
+                if (!packet.add(frame.arrivalNs, 0, frame.samples[s].id, frame.samples[s].value)) {
+                    ++sequence;
+                    packet.begin(sequence, frame.arrivalNs, 0);
+                    packet.add(frame.arrivalNs, 0, frame.samples[s].id, frame.samples[s].value);
+                }
+            }
+        }
+        meter.add(CorpusFrames);
+    }
+    QVERIFY(packet.sampleCount() > 0);
+}
+
+// The model side of MainWindow::processData(): latest-value snapshot,
+// registry dispatch and one dataChanged per table. Gauge painting is
+// measured by gaugebench.
+void PipelineBench::displayUpdate() {
+    const Corpus &data = corpus();
+    const SensorRegistry registry;
+    SensorTableModel values(SensorTableModel::Values);
+    SensorTableModel status(SensorTableModel::Status);
+    for (quint8 id : registry.valueIds()) {
+        values.addSensor(QString::fromUtf8(registry[id].name), registry[id].minValue, registry[id].maxValue);
+        status.addSensor(QString::fromUtf8(registry[id].name), registry[id].minValue, registry[id].maxValue);
+    }
+
+    double latest[SensorIdCount];
+    bool changed[SensorIdCount] = {};
+    StageMeter meter;
+    QBENCHMARK {
+        for (int i = 0; i < CorpusFrames; ++i) {
+            const DecodedFrame &frame = data.decoded[i];
+            for (int s = 0; s < frame.sensorCount; ++s) {
+                latest[frame.samples[s].id] = frame.samples[s].value;
+                changed[frame.samples[s].id] = true;
+            }
+            // One render tick per frame is the worst case
+            for (int id = 0; id < SensorIdCount; ++id) {
+                if (!changed[id])
+                    continue;
+                changed[id] = false;
+                const SensorDescriptor &sensor = registry[quint8(id)];
+                if (sensor.kind == SensorKind::Status)
+                    status.setError(sensor.tableRow, latest[id] == 1);
+                else if (sensor.kind == SensorKind::Value && latest[id] >= sensor.minValue && latest[id] <= sensor.maxValue)
+                    values.setValue(sensor.tableRow, latest[id]);
+            }
+            values.commit();
+            status.commit();
+        }
+        meter.add(CorpusFrames);
+    }
+}
+
+QTEST_GUILESS_MAIN(PipelineBench)
+
+#include "tst_pipelinebench.moc"
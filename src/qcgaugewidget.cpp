@@ -5,6 +5,9 @@ QcGaugeWidget::QcGaugeWidget(QWidget *parent) :
 	QWidget(parent)
 {
 	setMinimumSize(250, 250);
+	mCacheEnabled = true;
+	mCacheValid = false;
+	mCacheDpr = 0;
 }
 
 QcBackgroundItem *QcGaugeWidget::addBackground(float position)
@@ -90,10 +93,12 @@ void QcGaugeWidget::addItem(QcItem *item, float position)
 	item->setParent(this);
 	item->setPosition(position);
 	mItems.append(item);
+	invalidateCache();
 }
 
 int QcGaugeWidget::removeItem(QcItem *item)
 {
+	invalidateCache();
 	return mItems.removeAll(item);
 }
 
@@ -103,14 +108,79 @@ QList<QcItem *> QcGaugeWidget::items()
 }
 
 
+void QcGaugeWidget::setStaticCacheEnabled(bool enabled)
+{
+	mCacheEnabled = enabled;
+	invalidateCache();
+}
+
+bool QcGaugeWidget::staticCacheEnabled()
+{
+	return mCacheEnabled;
+}
+
+void QcGaugeWidget::invalidateCache()
+{
+	mCacheValid = false;
+	mStaticLayers.clear();
+	update();
+}
+
+void QcGaugeWidget::rebuildCache(qreal dpr)
+{
+	mStaticLayers.clear();
+	int i = 0;
+	while (i < mItems.size()) {
+		if (mItems[i]->isDynamic()) {
+			i++;
+			continue;
+		}
+		// One transparent layer per run of consecutive static items, so the
+		// stacking order with the dynamic items is kept
+		QPixmap layer(size() * dpr);
+		layer.setDevicePixelRatio(dpr);
+		layer.fill(Qt::transparent);
+		QPainter layerPainter(&layer);
+		layerPainter.setRenderHint(QPainter::Antialiasing);
+		while (i < mItems.size() && !mItems[i]->isDynamic())
+			mItems[i++]->draw(&layerPainter);
+		mStaticLayers.append(layer);
+	}
+	mCacheSize = size();
+	mCacheDpr = dpr;
+	mCacheValid = true;
+}
+
 void QcGaugeWidget::paintEvent(QPaintEvent *)
 {
 	QPainter painter(this);
-	painter.setRenderHint(QPainter::Antialiasing);
 
-	foreach(QcItem * item, mItems) {
-		item->draw(&painter);
+	if (!mCacheEnabled) {
+		painter.setRenderHint(QPainter::Antialiasing);
+		foreach(QcItem * item, mItems) {
+			item->draw(&painter);
+		}
+		emit painted();
+		return;
+	}
+
+	const qreal dpr = devicePixelRatioF();
+	if (!mCacheValid || mCacheSize != size() || mCacheDpr != dpr)
+		rebuildCache(dpr);
+
+	painter.setRenderHint(QPainter::Antialiasing);
+	int layer = 0;
+	int i = 0;
+	while (i < mItems.size()) {
+		if (mItems[i]->isDynamic()) {
+			mItems[i++]->draw(&painter);
+			continue;
+		}
+		painter.drawPixmap(0, 0, mStaticLayers[layer++]);
+		while (i < mItems.size() && !mItems[i]->isDynamic())
+			i++;
 	}
+	emit painted();
 }
 
 QcItem::QcItem(QObject *parent) :
@@ -119,6 +189,7 @@ QcItem::QcItem(QObject *parent) :
 
 	parentWidget = qobject_cast<QWidget*>(parent);
 	mPosition = 50;
+	mDynamic = false;
 }
 
 int QcItem::type()
@@ -128,7 +199,23 @@ int QcItem::type()
 
 void QcItem::update()
 {
-	parentWidget->update();
+	// A static item changed, so the cached layers are out of date
+	QcGaugeWidget *gauge = qobject_cast<QcGaugeWidget*>(parentWidget);
+	if (gauge && !mDynamic)
+		gauge->invalidateCache();
+	else if (parentWidget)
+		parentWidget->update();
+}
+
+void QcItem::setDynamic(bool dynamic)
+{
+	mDynamic = dynamic;
+	update();
+}
+
+bool QcItem::isDynamic()
+{
+	return mDynamic;
 }
 
 float QcItem::position()
@@ -223,7 +310,7 @@ void QcScaleItem::setValueRange(float minValue, float maxValue)
 		over_s = true;
 	mMinValue = minValue;
 	mMaxValue = maxValue;
-
+	update();
 }
 
 void QcScaleItem::setDgereeRange(float minDegree, float maxDegree)
@@ -232,6 +319,7 @@ void QcScaleItem::setDgereeRange(float minDegree, float maxDegree)
 		throw(InvalidValueRange);
 	mMinDegree = minDegree;
 	mMaxDegree = maxDegree;
+	update();
 }
 
 float QcScaleItem::getDegFromValue(float v)
@@ -318,6 +406,7 @@ void QcBackgroundItem::addColor(float position, const QColor &color)
 void QcBackgroundItem::clearrColors()
 {
 	mColors.clear();
+	update();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -446,6 +535,7 @@ void QcArcItem::draw(QPainter *painter)
 void QcArcItem::setColor(const QColor &color)
 {
 	mColor = color;
+	update();
 }
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -604,6 +694,7 @@ QcNeedleItem::QcNeedleItem(QObject *parent) :
 	mColor = Qt::black;
 	mLabel = NULL;
 	mNeedleType = FeatherNeedle;
+	mDynamic = true;
 }
 
 void QcNeedleItem::draw(QPainter *painter)
@@ -698,7 +789,10 @@ QColor QcNeedleItem::color()
 
 void QcNeedleItem::setLabel(QcLabelItem *label)
 {
+	// The label shows the current value, so it changes with the needle
 	mLabel = label;
+	if (mLabel != 0)
+		mLabel->setDynamic(true);
 	update();
 }
 
@@ -834,12 +928,14 @@ void QcValuesItem::paint_numeber(int val , QRectF  tmpRect , QPainter* painter)
 void QcValuesItem::setStep(float step)
 {
 	mStep = step;
+	update();
 }
 
 
 void QcValuesItem::setColor(const QColor& color)
 {
 	mColor = color;
+	update();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -851,6 +947,7 @@ QcAttitudeMeter::QcAttitudeMeter(QObject *parent) :
 {
 	mPitch = 0;
 	mRoll = 0;
+	mDynamic = true;
 }
 
 void QcAttitudeMeter::setCurrentPitch(float pitch)
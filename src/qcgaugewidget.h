@@ -7,6 +7,7 @@
 #include <QRectF>
 #include <QtMath>
 #include <QPainterPath>
+#include <QPixmap>
 
 
 
@@ -52,13 +53,26 @@ public:
 	QList <QcItem*> items();
 	QList <QcItem*> mItems;
 
+	// Static items are rendered once into cached pixmaps; only dynamic
+	// items (needles and their value labels) are drawn on every paint
+	void setStaticCacheEnabled(bool enabled);
+	bool staticCacheEnabled();
+	void invalidateCache();
+
 
 signals:
+	void painted();
 
 	public slots :
 private:
 	void paintEvent(QPaintEvent *);
+	void rebuildCache(qreal dpr);
 
+	bool mCacheEnabled;
+	bool mCacheValid;
+	qreal mCacheDpr;
+	QSize mCacheSize;
+	QList<QPixmap> mStaticLayers;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -76,6 +90,8 @@ public:
 	void setPosition(float percentage);
 	float position();
 	QRectF rect();
+	void setDynamic(bool dynamic);
+	bool isDynamic();
 	enum Error { InvalidValueRange, InvalidDegreeRange, InvalidStep };
 
 
@@ -87,6 +103,8 @@ protected:
 	QRectF resetRect();
 	void update();
 
+	bool mDynamic;
+
 private:
 	QRectF mRect;
 	QWidget *parentWidget;
@@ -0,0 +1,126 @@
+#include "replaysource.h"
+#include "monotonicclock.h"
+#include <QDebug>
+
+ReplaySource::ReplaySource(QObject *parent)
+    : QObject(parent), timer(new QTimer(this)), speed(1), next(0), anchorWallNs(0), anchorLogNs(0), total(0), current(0), playing(false) {
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &ReplaySource::step);
+}
+
+bool ReplaySource::open(const QString &fileName) {
+    close();
+    if (!log.open(fileName)) {
+        qWarning() << "Failed to open replay" << fileName << log.errorString();
+        return false;
+    }
+    total.store(log.recordCount(), std::memory_order_relaxed);
+    reassembler.reset();
+    return true;
+}
+
+void ReplaySource::close() {
+    pause();
+    log.close();
+    next = 0;
+    total.store(0, std::memory_order_relaxed);
+    current.store(0, std::memory_order_relaxed);
+}
+
+void ReplaySource::play() {
+    if (!log.isOpen() || next >= log.recordCount())
+        return;
+    playing.store(true, std::memory_order_relaxed);
+    restartClock();
+    timer->start(0);
+}
+
+void ReplaySource::pause() {
+    playing.store(false, std::memory_order_relaxed);
+    timer->stop();
+}
+
+void ReplaySource::seek(qint64 record) {
+    next = qBound<qint64>(0, record, log.recordCount());
+    current.store(next, std::memory_order_relaxed);
+    reassembler.reset();
+    if (isPlaying()) {
+        restartClock();
+        timer->start(0);
+    }
+}
+
+void ReplaySource::setSpeed(double factor) {
+    speed = factor;
+    if (isPlaying())
+        restartClock();
+}
+
+// Maps the next record's log time onto now
+void ReplaySource::restartClock() {
+    anchorWallNs = monotonicNanoseconds();
+    anchorLogNs = next < log.recordCount() ? log.record(next).timestampNs : 0;
+}
+
+void ReplaySource::step() {
+    if (!isPlaying())
+        return;
+
+    const qint64 now = monotonicNanoseconds();
+    const qint64 count = log.recordCount();
+    for (int sent = 0; sent < MaxBatch && next < count; ++sent) {
+        if (speed > 0) {
+            const qint64 dueNs = anchorWallNs + qint64((log.record(next).timestampNs - anchorLogNs) / speed);
+            if (dueNs > now) {
+                current.store(next, std::memory_order_relaxed);
+                timer->start(int((dueNs - now + 999999) / 1000000));
+                return;
+            }
+        }
+        sendRecord(next);
+        ++next;
+    }
+    current.store(next, std::memory_order_relaxed);
+
+    if (next >= count) {
+        playing.store(false, std::memory_order_relaxed);
+        emit finished();
+        return;
+    }
+    timer->start(0);
+}
+
+void ReplaySource::sendRecord(qint64 index) {
+    const BinaryLogRecordHeader &record = log.record(index);
+    const BinaryLogField *fields = log.fields(index);
+    const int sensorCount = log.sensorCount();
+
+    // Values first, then the error flags, as the device sends them. A flag
+    // is only sent where the logged frame carried one.
+    int count = 0;
+    for (int i = 0; i < sensorCount && count < FrameReassembler::MaxSensors; ++i) {
+        if (!(fields[i].status & BinaryLogField::Present))
+            continue;
+        SensorSample &sample = frame.samples[count++];
+        sample.id = log.sensor(i).id;
+        sample.rawValue = fields[i].rawValue;
+        sample.factor = fields[i].factor;
+    }
+    for (int i = 0; i < sensorCount && count < FrameReassembler::MaxSensors; ++i) {
+        if (!(fields[i].status & BinaryLogField::StatusPresent) || log.sensor(i).statusId == 0)
+            continue;
+        SensorSample &sample = frame.samples[count++];
+        sample.id = log.sensor(i).statusId;
+        sample.rawValue = (fields[i].status & BinaryLogField::Error) ? 1 : 0;
+        sample.factor = 0;
+    }
+    frame.counter = record.counter;
+    frame.sensorCount = quint8(count);
+
+    const int size = encodeFrame(frame, wire);
+    reassembler.append(reinterpret_cast<const char *>(wire), size);
+    int frameSize;
+    while ((frameSize = reassembler.nextFrame()) > 0)
+        emit frameReceived(reassembler.frame(), frameSize, monotonicNanoseconds());
+}
@@ -0,0 +1,65 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include "binarylog.h"
+#include "framedecoder.h"
+#include "framereassembler.h"
+
+// Plays a binary run log back as a frame source. Each record is encoded
+// into its wire form again and cut by a FrameReassembler, so the frames
+// take exactly the path that serial data does. Records are paced by their
+// logged timestamps scaled by the speed, or sent as fast as possible when
+// the speed is 0.
+class ReplaySource : public QObject {
+    Q_OBJECT
+public:
+    explicit ReplaySource(QObject *parent = nullptr);
+
+    // Must be called on the source's thread
+    bool open(const QString &fileName);
+    void close();
+    void play();
+    void pause();
+    void seek(qint64 record);
+    void setSpeed(double factor);
+
+    bool isOpen() const { return log.isOpen(); }
+    QString errorString() const { return log.errorString(); }
+
+    // Safe to read from any thread
+    qint64 recordCount() const { return total.load(std::memory_order_relaxed); }
+    qint64 position() const { return current.load(std::memory_order_relaxed); }
+    bool isPlaying() const { return playing.load(std::memory_order_relaxed); }
+
+signals:
+    // Same contract as SerialHandler::frameReceived()
+    void frameReceived(const quint8 *frame, int size, qint64 arrivalNs);
+    void finished();
+
+private slots:
+    void step();
+
+private:
+    static const int MaxBatch = 256; // records per step, keeps the thread responsive
+
+    void restartClock();
+    void sendRecord(qint64 index);
+
+    BinaryLogReader log;
+    FrameReassembler reassembler;
+    QTimer *timer;
+    DecodedFrame frame;
+    quint8 wire[FrameReassembler::MaxFrameSize];
+    double speed;
+    qint64 next;
+    qint64 anchorWallNs;
+    qint64 anchorLogNs;
+    std::atomic<qint64> total;
+    std::atomic<qint64> current;
+    std::atomic<bool> playing;
+};
+
+#endif // REPLAYSOURCE_H
@@ -0,0 +1,172 @@
+#include "runstatistics.h"
+#include "sensorregistry.h"
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+
+P2Quantile::P2Quantile(double quantile) : p(quantile) {
+    reset();
+}
+
+void P2Quantile::reset() {
+    for (int i = 0; i < 5; ++i) {
+        heights[i] = 0;
+        positions[i] = i + 1;
+    }
+    desired[0] = 1;
+    desired[1] = 1 + 2 * p;
+    desired[2] = 1 + 4 * p;
+    desired[3] = 3 + 2 * p;
+    desired[4] = 5;
+    increments[0] = 0;
+    increments[1] = p / 2;
+    increments[2] = p;
+    increments[3] = (1 + p) / 2;
+    increments[4] = 1;
+    count = 0;
+}
+
+void P2Quantile::add(double value) {
+    // The first five samples are the markers themselves
+    if (count < 5) {
+        heights[count++] = value;
+        if (count == 5)
+            std::sort(heights, heights + 5);
+        return;
+    }
+
+    int cell;
+    if (value < heights[0]) {
+        heights[0] = value;
+        cell = 0;
+    } else if (value >= heights[4]) {
+        heights[4] = value;
+        cell = 3;
+    } else {
+        cell = 0;
+        while (value >= heights[cell + 1])
+            ++cell;
+    }
+    for (int i = cell + 1; i < 5; ++i)
+        positions[i] += 1;
+    for (int i = 0; i < 5; ++i)
+        desired[i] += increments[i];
+
+    // Move the middle markers towards their desired positions
+    for (int i = 1; i < 4; ++i) {
+        const double offset = desired[i] - positions[i];
+        if ((offset >= 1 && positions[i + 1] - positions[i] > 1) || (offset <= -1 && positions[i - 1] - positions[i] < -1)) {
+            const double d = offset > 0 ? 1 : -1;
+            const double parabolic = heights[i] + d / (positions[i + 1] - positions[i - 1])
+                * ((positions[i] - positions[i - 1] + d) * (heights[i + 1] - heights[i]) / (positions[i + 1] - positions[i])
+                   + (positions[i + 1] - positions[i] - d) * (heights[i] - heights[i - 1]) / (positions[i] - positions[i - 1]));
+            if (heights[i - 1] < parabolic && parabolic < heights[i + 1]) {
+                heights[i] = parabolic;
+            } else {
+                const int j = i + int(d);
+                heights[i] += d * (heights[j] - heights[i]) / (positions[j] - positions[i]);
+            }
+            positions[i] += d;
+        }
+    }
+    ++count;
+}
+
+double P2Quantile::value() const {
+    if (count >= 5)
+        return heights[2];
+    if (count == 0)
+        return 0;
+
+    // Too few samples for the markers: take the nearest rank
+    double sorted[5];
+    std::copy(heights, heights + count, sorted);
+    std::sort(sorted, sorted + count);
+    return sorted[qBound(0, int(std::ceil(p * count)) - 1, count - 1)];
+}
+
+RunStatistics::RunStatistics() {
+    std::fill(channelOf, channelOf + 256, qint16(-1));
+}
+
+void RunStatistics::setChannels(const QVector<quint8> &ids) {
+    std::fill(channelOf, channelOf + 256, qint16(-1));
+    channels.resize(ids.size());
+    for (int c = 0; c < ids.size(); ++c) {
+        channelOf[ids[c]] = qint16(c);
+        channels[c].id = ids[c];
+    }
+    clear();
+}
+
+void RunStatistics::clear() {
+    for (Channel &channel : channels) {
+        channel.count = 0;
+        channel.minimum = 0;
+        channel.maximum = 0;
+        channel.mean = 0;
+        channel.m2 = 0;
+        channel.p50 = P2Quantile(0.50);
+        channel.p95 = P2Quantile(0.95);
+        channel.p99 = P2Quantile(0.99);
+    }
+}
+
+void RunStatistics::addTo(Channel &channel, double value) {
+    if (channel.count == 0) {
+        channel.minimum = value;
+        channel.maximum = value;
+    } else {
+        channel.minimum = qMin(channel.minimum, value);
+        channel.maximum = qMax(channel.maximum, value);
+    }
+
+    // Welford: stable without keeping the samples
+    ++channel.count;
+    const double delta = value - channel.mean;
+    channel.mean += delta / double(channel.count);
+    channel.m2 += delta * (value - channel.mean);
+
+    channel.p50.add(value);
+    channel.p95.add(value);
+    channel.p99.add(value);
+}
+
+QVector<SensorStatistics> RunStatistics::summary(quint8 source) const {
+    QVector<SensorStatistics> result;
+    result.reserve(channels.size());
+    for (const Channel &channel : channels) {
+        const double variance = channel.count > 1 ? channel.m2 / double(channel.count - 1) : 0;
+        result.append({ source, channel.id, channel.count, channel.minimum, channel.maximum, channel.mean,
+                        std::sqrt(variance), channel.p50.value(), channel.p95.value(), channel.p99.value() });
+    }
+    return result;
+}
+
+bool writeStatisticsCsv(const QString &fileName, const QVector<SensorStatistics> &summary,
+                        const SensorRegistry &registry, QString *error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    file.write("Port,Sensor ID,Sensor,Count,Min,Max,Mean,Std Dev,P50,P95,P99\n");
+    for (const SensorStatistics &sensor : summary) {
+        const QString line = QString("%1,0x%2,%3,%4,%5,%6,%7,%8,%9,%10,%11\n")
+                                 .arg(sensor.source + 1)
+                                 .arg(sensor.id, 2, 16, QChar('0'))
+                                 .arg(QString::fromUtf8(registry[sensor.id].name))
+                                 .arg(sensor.count)
+                                 .arg(sensor.minimum, 0, 'g', 10)
+                                 .arg(sensor.maximum, 0, 'g', 10)
+                                 .arg(sensor.mean, 0, 'g', 10)
+                                 .arg(sensor.standardDeviation, 0, 'g', 10)
+                                 .arg(sensor.p50, 0, 'g', 10)
+                                 .arg(sensor.p95, 0, 'g', 10)
+                                 .arg(sensor.p99, 0, 'g', 10);
+        file.write(line.toUtf8());
+    }
+    return true;
+}
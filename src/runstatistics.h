@@ -0,0 +1,86 @@
+#ifndef RUNSTATISTICS_H
+#define RUNSTATISTICS_H
+
+#include <QString>
+#include <QVector>
+
+class SensorRegistry;
+
+// Streaming quantile estimate after Jain and Chlamtac's P² algorithm: five
+// markers whose heights are adjusted with a parabolic fit as samples
+// arrive. Constant memory and a handful of comparisons per sample.
+class P2Quantile {
+public:
+    explicit P2Quantile(double quantile = 0.5);
+
+    void reset();
+    void add(double value);
+    double value() const;
+
+private:
+    double p;
+    double heights[5];
+    double positions[5];
+    double desired[5];
+    double increments[5];
+    int count;
+};
+
+struct SensorStatistics {
+    quint8 source;
+    quint8 id;
+    quint64 count;
+    double minimum;
+    double maximum;
+    double mean;
+    double standardDeviation;
+    double p50;
+    double p95;
+    double p99;
+};
+
+// Per-sensor statistics of a run, updated with every sample on the
+// acquisition thread: count, min, max, Welford mean and variance, and P²
+// estimates of the median, 95th and 99th percentile. Memory per channel is
+// fixed and every update is O(1), however long the run.
+class RunStatistics {
+public:
+    RunStatistics();
+
+    // One channel per ID; drops all data
+    void setChannels(const QVector<quint8> &ids);
+    void clear();
+
+    void add(quint8 id, double value) {
+        const int channel = channelOf[id];
+        if (channel >= 0)
+            addTo(channels[channel], value);
+    }
+
+    // In setChannels() order, tagged with source
+    QVector<SensorStatistics> summary(quint8 source = 0) const;
+
+private:
+    struct Channel {
+        quint8 id;
+        quint64 count;
+        double minimum;
+        double maximum;
+        double mean;
+        double m2;
+        P2Quantile p50;
+        P2Quantile p95;
+        P2Quantile p99;
+    };
+
+    static void addTo(Channel &channel, double value);
+
+    QVector<Channel> channels;
+    qint16 channelOf[256];
+};
+
+// Writes a summary as CSV with full precision
+bool writeStatisticsCsv(const QString &fileName, const QVector<SensorStatistics> &summary,
+                        const SensorRegistry &registry, QString *error = nullptr);
+
+#endif // RUNSTATISTICS_H
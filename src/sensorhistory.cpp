@@ -0,0 +1,214 @@
+#include "sensorhistory.h"
+#include <algorithm>
+
+// Bytes per entry: raw is time + value, a bucket is time, min, max, mean
+// and count
+static const int RawEntrySize = int(sizeof(qint64) + sizeof(float));
+static const int BucketEntrySize = int(sizeof(qint64) + 3 * sizeof(float) + sizeof(quint32));
+
+// Share of the budget per level; raw data dominates, the coarse tiers are
+// cheap and reach back furthest
+static const double BudgetShare[SensorHistory::LevelCount] = { 0.70, 0.15, 0.10, 0.05 };
+
+SensorHistory::SensorHistory(qint64 memoryBudget) : budget(memoryBudget) {
+    std::fill(channelOf, channelOf + 256, qint16(-1));
+    std::fill(capacities, capacities + LevelCount, 0);
+}
+
+qint64 SensorHistory::periodNs(Level level) {
+    static const qint64 periods[LevelCount] = { 0, 1000000000LL, 10000000000LL, 60000000000LL };
+    return periods[level];
+}
+
+void SensorHistory::setChannels(const QVector<quint8> &ids) {
+    std::fill(channelOf, channelOf + 256, qint16(-1));
+    channels.clear();
+    channels.resize(ids.size());
+    if (ids.isEmpty())
+        return;
+
+    for (int level = 0; level < LevelCount; ++level) {
+        const int entrySize = level == Raw ? RawEntrySize : BucketEntrySize;
+        capacities[level] = qMax(16, int(budget * BudgetShare[level] / ids.size() / entrySize));
+    }
+
+    for (int c = 0; c < ids.size(); ++c) {
+        channelOf[ids[c]] = qint16(c);
+        for (int level = 0; level < LevelCount; ++level) {
+            Tier &tier = channels[c].tiers[level];
+            const int capacity = capacities[level];
+            tier.time.resize(capacity);
+            tier.mean.resize(capacity);
+            if (level != Raw) {
+                tier.minimum.resize(capacity);
+                tier.maximum.resize(capacity);
+                tier.count.resize(capacity);
+            }
+            resetTier(tier);
+        }
+    }
+}
+
+void SensorHistory::resetTier(Tier &tier) {
+    tier.head = 0;
+    tier.size = 0;
+    tier.openStart = -1;
+    tier.openMin = 0;
+    tier.openMax = 0;
+    tier.openSum = 0;
+    tier.openCount = 0;
+}
+
+void SensorHistory::clear() {
+    for (Channel &channel : channels) {
+        for (Tier &tier : channel.tiers)
+            resetTier(tier);
+    }
+}
+
+qint64 SensorHistory::memoryUsage() const {
+    qint64 bytes = 0;
+    for (int level = 0; level < LevelCount; ++level)
+        bytes += qint64(capacities[level]) * (level == Raw ? RawEntrySize : BucketEntrySize);
+    return bytes * channels.size();
+}
+
+int SensorHistory::Tier::slot(int index) const {
+    const int capacity = time.size();
+    int position = head - size + index;
+    if (position < 0)
+        position += capacity;
+    return position;
+}
+
+// Logical index of the first entry at or after timeNs
+int SensorHistory::Tier::lowerBound(qint64 timeNs) const {
+    int low = 0;
+    int high = size;
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (time[slot(middle)] < timeNs)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+void SensorHistory::appendTo(Channel &channel, qint64 timeNs, float value) {
+    Tier &raw = channel.tiers[Raw];
+    const int capacity = raw.time.size();
+    raw.time[raw.head] = timeNs;
+    raw.mean[raw.head] = value;
+    if (++raw.head == capacity)
+        raw.head = 0;
+    if (raw.size < capacity)
+        ++raw.size;
+
+    addToBucket(channel, Seconds1, timeNs, value, value, value, 1);
+}
+
+void SensorHistory::addToBucket(Channel &channel, int level, qint64 timeNs, float minValue, float maxValue,
+                                double sum, quint32 count) {
+    Tier &tier = channel.tiers[level];
+    const qint64 period = periodNs(Level(level));
+    const qint64 start = timeNs - timeNs % period;
+
+    if (tier.openCount > 0 && start != tier.openStart) {
+        // Close the bucket and fold it into the next coarser tier
+        const int capacity = tier.time.size();
+        const float mean = float(tier.openSum / tier.openCount);
+        tier.time[tier.head] = tier.openStart;
+        tier.minimum[tier.head] = tier.openMin;
+        tier.maximum[tier.head] = tier.openMax;
+        tier.mean[tier.head] = mean;
+        tier.count[tier.head] = tier.openCount;
+        if (++tier.head == capacity)
+            tier.head = 0;
+        if (tier.size < capacity)
+            ++tier.size;
+
+        if (level + 1 < LevelCount)
+            addToBucket(channel, level + 1, tier.openStart, tier.openMin, tier.openMax, tier.openSum, tier.openCount);
+        tier.openCount = 0;
+    }
+
+    if (tier.openCount == 0) {
+        tier.openStart = start;
+        tier.openMin = minValue;
+        tier.openMax = maxValue;
+        tier.openSum = sum;
+        tier.openCount = count;
+        return;
+    }
+    tier.openMin = qMin(tier.openMin, minValue);
+    tier.openMax = qMax(tier.openMax, maxValue);
+    tier.openSum += sum;
+    tier.openCount += count;
+}
+
+qint64 SensorHistory::firstTime(quint8 id, Level level) const {
+    const int channel = channelOf[id];
+    if (channel < 0)
+        return 0;
+    const Tier &tier = channels[channel].tiers[level];
+    if (tier.size > 0)
+        return tier.time[tier.slot(0)];
+    return tier.openCount > 0 ? tier.openStart : 0;
+}
+
+qint64 SensorHistory::lastTime(quint8 id, Level level) const {
+    const int channel = channelOf[id];
+    if (channel < 0)
+        return 0;
+    const Tier &tier = channels[channel].tiers[level];
+    if (tier.openCount > 0)
+        return tier.openStart;
+    return tier.size > 0 ? tier.time[tier.slot(tier.size - 1)] : 0;
+}
+
+SensorHistory::Level SensorHistory::levelFor(quint8 id, qint64 fromNs, qint64 toNs, int maxPoints) const {
+    const int channel = channelOf[id];
+    if (channel < 0)
+        return Minutes1;
+
+    // Raw is picked by how many samples are actually in the range
+    const Tier &raw = channels[channel].tiers[Raw];
+    if (raw.size > 0 && raw.time[raw.slot(0)] <= fromNs
+        && raw.lowerBound(toNs) - raw.lowerBound(fromNs) <= maxPoints)
+        return Raw;
+
+    for (int level = Seconds1; level < Minutes1; ++level) {
+        if ((toNs - fromNs) / periodNs(Level(level)) <= maxPoints && firstTime(id, Level(level)) <= fromNs)
+            return Level(level);
+    }
+    return Minutes1;
+}
+
+int SensorHistory::read(quint8 id, Level level, qint64 fromNs, qint64 toNs, QVector<Point> &out) const {
+    const int channel = channelOf[id];
+    if (channel < 0)
+        return 0;
+    const Tier &tier = channels[channel].tiers[level];
+    const int before = out.size();
+
+    // A bucket overlaps the range if it ends after fromNs
+    const qint64 period = periodNs(level);
+    int index = tier.lowerBound(fromNs - period + (period > 0 ? 1 : 0));
+    for (; index < tier.size; ++index) {
+        const int slot = tier.slot(index);
+        const qint64 timeNs = tier.time[slot];
+        if (timeNs >= toNs)
+            break;
+        if (level == Raw) {
+            const float value = tier.mean[slot];
+            out.append({ timeNs, value, value, value });
+        } else {
+            out.append({ timeNs, tier.minimum[slot], tier.maximum[slot], tier.mean[slot] });
+        }
+    }
+
+    if (level != Raw && tier.openCount > 0 && tier.openStart < toNs && tier.openStart + period > fromNs)
+        out.append({ tier.openStart, tier.openMin, tier.openMax, float(tier.openSum / tier.openCount) });
+    return out.size() - before;
+}
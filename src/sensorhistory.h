@@ -0,0 +1,94 @@
+#ifndef SENSORHISTORY_H
+#define SENSORHISTORY_H
+
+#include <QtGlobal>
+#include <QVector>
+
+// Per-sensor time series kept in memory for trends.
+//
+// Every channel has a ring of raw samples and three rollup tiers (1 s, 10 s,
+// 1 min) of min/max/mean buckets, all stored as separate arrays per field.
+// Each 1 s bucket that closes is folded into the 10 s tier and so on, so an
+// append touches the raw ring and one open bucket. All rings are allocated
+// up front from the memory budget and never grow; the oldest entries are
+// overwritten. Not thread-safe: append and read on the same thread.
+class SensorHistory {
+public:
+    enum Level { Raw, Seconds1, Seconds10, Minutes1 };
+    static const int LevelCount = 4;
+    static const qint64 DefaultBudget = 64 * 1024 * 1024;
+
+    struct Point {
+        qint64 timeNs; // sample time, or bucket start
+        float minValue;
+        float maxValue;
+        float mean;
+    };
+
+    explicit SensorHistory(qint64 memoryBudget = DefaultBudget);
+
+    // Takes effect at the next setChannels()
+    void setMemoryBudget(qint64 bytes) { budget = bytes; }
+    // Allocates one channel per ID and drops all data
+    void setChannels(const QVector<quint8> &ids);
+    void clear();
+
+    void append(quint8 id, qint64 timeNs, float value) {
+        const int channel = channelOf[id];
+        if (channel >= 0)
+            appendTo(channels[channel], timeNs, value);
+    }
+
+    bool contains(quint8 id) const { return channelOf[id] >= 0; }
+    int capacity(Level level) const { return capacities[level]; }
+    qint64 memoryUsage() const;
+    static qint64 periodNs(Level level);
+
+    // Oldest and newest time held at a level, 0 if empty
+    qint64 firstTime(quint8 id, Level level) const;
+    qint64 lastTime(quint8 id, Level level) const;
+
+    // Finest level that covers [fromNs, toNs) with at most maxPoints points
+    // and still holds data from fromNs
+    Level levelFor(quint8 id, qint64 fromNs, qint64 toNs, int maxPoints) const;
+
+    // Appends the points of [fromNs, toNs) to out, oldest first, including
+    // the bucket that is still filling. Returns the number appended.
+    int read(quint8 id, Level level, qint64 fromNs, qint64 toNs, QVector<Point> &out) const;
+
+private:
+    struct Tier {
+        QVector<qint64> time;
+        QVector<float> minimum; // empty on the raw tier
+        QVector<float> maximum;
+        QVector<float> mean;    // the sample itself on the raw tier
+        QVector<quint32> count;
+        int head;               // next slot to write
+        int size;
+
+        // Bucket being filled
+        qint64 openStart;
+        float openMin;
+        float openMax;
+        double openSum;
+        quint32 openCount;
+
+        int slot(int index) const; // index 0 is the oldest entry
+        int lowerBound(qint64 timeNs) const;
+    };
+
+    struct Channel {
+        Tier tiers[LevelCount];
+    };
+
+    void appendTo(Channel &channel, qint64 timeNs, float value);
+    void addToBucket(Channel &channel, int level, qint64 timeNs, float minValue, float maxValue, double sum, quint32 count);
+    static void resetTier(Tier &tier);
+
+    QVector<Channel> channels;
+    qint16 channelOf[256];
+    qint64 budget;
+    int capacities[LevelCount];
+};
+
+#endif // SENSORHISTORY_H
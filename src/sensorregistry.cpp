@@ -0,0 +1,198 @@
+#include "sensorregistry.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <limits>
+
+static AlarmLimits noLimits() {
+    const float none = std::numeric_limits<float>::infinity();
+    return { -none, -none, none, none, 0, 0, 0, false };
+}
+
+static AlarmLimits defaultLimits(const SensorDescriptor &sensor) {
+    const float none = std::numeric_limits<float>::infinity();
+    if (sensor.kind != SensorKind::Value)
+        return noLimits();
+    const float hysteresis = (sensor.maxValue - sensor.minValue) / 100;
+    return { sensor.minValue, -none, none, sensor.maxValue, hysteresis, 0, 0, true };
+}
+
+SensorRegistry::SensorRegistry() : table(BuiltinSensors), rows(0) {
+    for (const SensorDescriptor &sensor : table) {
+        if (sensor.tableRow >= rows)
+            rows = sensor.tableRow + 1;
+        limits[sensor.id] = defaultLimits(sensor);
+    }
+    spectrum = { 0x0D, 256, 0.75, {} };
+}
+
+QVector<quint8> SensorRegistry::valueIds() const {
+    QVector<quint8> ids(rows, 0);
+    for (const SensorDescriptor &sensor : table) {
+        if (sensor.kind == SensorKind::Value)
+            ids[sensor.tableRow] = sensor.id;
+    }
+    return ids;
+}
+
+const char *SensorRegistry::keep(const QString &text) {
+    strings.push_back(text.toUtf8());
+    return strings.back().constData();
+}
+
+static int jsonId(const QJsonValue &value) {
+    if (value.isDouble())
+        return value.toInt(-1);
+    bool ok = false;
+    const int id = value.toString().toInt(&ok, 0);
+    return ok ? id : -1;
+}
+
+static SensorDescriptor unusedSensor(quint8 id) {
+    SensorDescriptor sensor = BuiltinSensors[0];
+    sensor.id = id;
+    return sensor;
+}
+
+static void readLimit(const QJsonObject &object, const char *key, float &limit) {
+    if (object.contains(QLatin1String(key)))
+        limit = float(object.value(QLatin1String(key)).toDouble());
+}
+
+static void readLimits(const QJsonObject &object, AlarmLimits &limits) {
+    readLimit(object, "criticalLow", limits.criticalLow);
+    readLimit(object, "warningLow", limits.warningLow);
+    readLimit(object, "warningHigh", limits.warningHigh);
+    readLimit(object, "criticalHigh", limits.criticalHigh);
+    readLimit(object, "hysteresis", limits.hysteresis);
+    readLimit(object, "maxRate", limits.maxRate);
+    limits.delayMs = object.value("delayMs").toInt(limits.delayMs);
+    limits.latching = object.value("latching").toBool(limits.latching);
+}
+
+static void setError(QString *error, const QString &text) {
+    if (error)
+        *error = text;
+}
+
+bool SensorRegistry::loadJson(const QString &fileName, QString *error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, file.errorString());
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (document.isNull()) {
+        setError(error, parseError.errorString());
+        return false;
+    }
+
+    // Entries are applied to copies, so a file with an invalid entry
+    // changes nothing
+    SensorTable newTable = table;
+    std::array<AlarmLimits, SensorIdCount> newLimits = limits;
+    SpectrumSettings newSpectrum = spectrum;
+    int newRows = rows;
+    const size_t keptStrings = strings.size();
+
+    const QJsonArray entries = document.object().value("sensors").toArray();
+    for (const QJsonValue &entry : entries) {
+        const QJsonObject object = entry.toObject();
+        const int id = jsonId(object.value("id"));
+        // Without statusId an existing value sensor keeps its error flag
+        const bool keepsStatus = !object.contains("statusId") && id > 0 && id < SensorIdCount
+                                 && newTable[id].kind == SensorKind::Value;
+        const int statusId = object.contains("statusId") ? jsonId(object.value("statusId"))
+                                                         : keepsStatus ? newTable[id].pairedId : 0;
+        const int gauge = object.value("gauge").toInt(NoGauge);
+        if (id <= 0 || id >= SensorIdCount || statusId < 0 || statusId >= SensorIdCount || statusId == id
+            || gauge < NoGauge || gauge >= GaugeCount
+            || (statusId != 0 && newTable[statusId].kind == SensorKind::Value)) {
+            setError(error, QString("Invalid sensor entry %1").arg(QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact))));
+            strings.resize(keptStrings);
+            return false;
+        }
+
+        // Unlink whatever the two IDs were paired with before
+        SensorDescriptor &sensor = newTable[id];
+        if (sensor.kind == SensorKind::Value && sensor.pairedId != 0 && sensor.pairedId != statusId)
+            newTable[sensor.pairedId] = unusedSensor(sensor.pairedId);
+        if (sensor.kind == SensorKind::Status)
+            newTable[sensor.pairedId].pairedId = 0;
+        if (statusId != 0 && newTable[statusId].kind == SensorKind::Status)
+            newTable[newTable[statusId].pairedId].pairedId = 0;
+        const qint16 row = sensor.kind == SensorKind::Value ? sensor.tableRow : qint16(newRows++);
+
+        // A gauge shows a single sensor
+        if (gauge != NoGauge) {
+            for (SensorDescriptor &other : newTable) {
+                if (other.gauge == gauge)
+                    other.gauge = NoGauge;
+            }
+        }
+
+        sensor.kind = SensorKind::Value;
+        sensor.id = quint8(id);
+        sensor.pairedId = quint8(statusId);
+        sensor.gauge = qint8(gauge);
+        sensor.tableRow = row;
+        sensor.minValue = float(object.value("min").toDouble(0));
+        sensor.maxValue = float(object.value("max").toDouble(0));
+        sensor.name = keep(object.value("name").toString(QString("Sensor 0x%1").arg(id, 2, 16, QChar('0'))));
+        sensor.unit = keep(object.value("unit").toString());
+
+        AlarmLimits &alarm = newLimits[id];
+        alarm = defaultLimits(sensor);
+        readLimits(object.value("alarm").toObject(), alarm);
+
+        if (statusId != 0) {
+            SensorDescriptor &status = newTable[statusId];
+            status = sensor;
+            status.kind = SensorKind::Status;
+            status.id = quint8(statusId);
+            status.pairedId = quint8(id);
+            status.gauge = NoGauge;
+            status.minValue = 0;
+            status.maxValue = 1;
+            newLimits[statusId] = defaultLimits(status);
+        }
+    }
+
+    if (document.object().contains("spectrum")) {
+        const QJsonObject object = document.object().value("spectrum").toObject();
+        const int id = object.contains("id") ? jsonId(object.value("id")) : newSpectrum.id;
+        const int size = object.value("size").toInt(newSpectrum.size);
+        const double overlap = object.value("overlap").toDouble(newSpectrum.overlap);
+        const QJsonArray bands = object.value("bands").toArray();
+        if (id < 0 || id >= SensorIdCount || size < 16 || overlap < 0 || overlap >= 1
+            || bands.size() > SpectrumSettings::MaxBands) {
+            setError(error, "Invalid spectrum settings");
+            strings.resize(keptStrings);
+            return false;
+        }
+        newSpectrum.id = quint8(id);
+        newSpectrum.size = size;
+        newSpectrum.overlap = overlap;
+        newSpectrum.bands.clear();
+        for (const QJsonValue &entry : bands) {
+            const QJsonObject band = entry.toObject();
+            SpectrumBand item = { float(band.value("lowHz").toDouble()), float(band.value("highHz").toDouble()), noLimits() };
+            readLimits(band.value("alarm").toObject(), item.limits);
+            newSpectrum.bands.append(item);
+        }
+    }
+
+    table = newTable;
+    limits = newLimits;
+    spectrum = newSpectrum;
+    rows = newRows;
+    return true;
+}
+
+SensorRegistry &sensorRegistry() {
+    static SensorRegistry registry;
+    return registry;
+}
@@ -0,0 +1,161 @@
+#ifndef SENSORREGISTRY_H
+#define SENSORREGISTRY_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <array>
+#include <deque>
+
+enum class SensorKind : quint8 { Unused, Value, Status };
+
+// Gauges on the main page, in layout order
+enum SensorGauge : qint8 {
+    NoGauge = -1,
+    OilPressureGauge,
+    OilTempGauge,
+    FuelGauge,
+    TorqueGauge,
+    MotorSpeedGauge,
+    VibrationGauge,
+    GaugeCount
+};
+
+struct SensorDescriptor {
+    SensorKind kind;
+    quint8 id;
+    quint8 pairedId; // status ID of a value sensor, value ID of a status flag, 0 if none
+    qint8 gauge;     // SensorGauge
+    qint16 tableRow; // row in the data and status tables, shared by a sensor and its flag
+    float minValue;
+    float maxValue;
+    const char *name;
+    const char *unit;
+};
+
+static const int SensorIdCount = 256;
+typedef std::array<SensorDescriptor, SensorIdCount> SensorTable;
+
+// Alarm conditions of a value sensor. Limits that are not used are infinite.
+struct AlarmLimits {
+    float criticalLow;
+    float warningLow;
+    float warningHigh;
+    float criticalHigh;
+    float hysteresis; // how far back inside a limit the value must go to clear it
+    float maxRate;    // units per second before a warning, 0 for none
+    qint32 delayMs;   // how long a condition must hold before it is raised
+    bool latching;    // stays raised until acknowledged
+};
+
+// Frequency band of the spectrum analysis; limits apply to its RMS
+struct SpectrumBand {
+    float lowHz;
+    float highHz;
+    AlarmLimits limits;
+};
+
+struct SpectrumSettings {
+    static const int MaxBands = 8;
+
+    quint8 id;   // analysed sensor, 0 for none
+    int size;    // FFT length
+    double overlap; // fraction of a window shared with the next
+    QVector<SpectrumBand> bands;
+};
+
+struct BuiltinSensor {
+    quint8 id;
+    const char *name;
+    float minValue;
+    float maxValue;
+    qint8 gauge;
+};
+
+// The sensors of the protocol specification. Sensor id reports its error
+// flag on id + 0x10.
+inline constexpr BuiltinSensor BuiltinSensorList[] = {
+    { 0x01, "Oil Pressure", 0, 1000, OilPressureGauge },
+    { 0x02, "Oil Temp", 0, 400, OilTempGauge },
+    { 0x03, "Fuel Flow", 0, 800, NoGauge },
+    { 0x04, "Fuel", 0, 800, FuelGauge },
+    { 0x05, "EGT", 0, 400, NoGauge },
+    { 0x06, "Torque", 0, 400, TorqueGauge },
+    { 0x07, "Indicated Power", 0, 400, NoGauge },
+    { 0x08, "Friction Power", 0, 400, NoGauge },
+    { 0x09, "Therm Efficiency", 0, 100, NoGauge },
+    { 0x0A, "Air-Fuel Ratio", 0, 20, NoGauge },
+    { 0x0B, "Motor Speed", 0, 1000, MotorSpeedGauge },
+    { 0x0C, "Output Air Speed", 0, 1000, NoGauge },
+    { 0x0D, "Vibration", 0, 100, VibrationGauge },
+    { 0x0E, "Body Temp", 0, 400, NoGauge },
+    { 0x0F, "Air Temp", 0, 400, NoGauge },
+};
+
+constexpr SensorTable makeSensorTable() {
+    SensorTable table {};
+    for (int id = 0; id < SensorIdCount; ++id)
+        table[id] = { SensorKind::Unused, quint8(id), 0, NoGauge, -1, 0, 0, "", "" };
+
+    qint16 row = 0;
+    for (const BuiltinSensor &sensor : BuiltinSensorList) {
+        const quint8 statusId = quint8(sensor.id + 0x10);
+        table[sensor.id] = { SensorKind::Value, sensor.id, statusId, sensor.gauge, row,
+                             sensor.minValue, sensor.maxValue, sensor.name, "" };
+        table[statusId] = { SensorKind::Status, statusId, sensor.id, NoGauge, row, 0, 1, sensor.name, "" };
+        ++row;
+    }
+    return table;
+}
+
+inline constexpr SensorTable BuiltinSensors = makeSensorTable();
+
+static_assert(BuiltinSensors[0x0D].gauge == VibrationGauge, "Sensor table out of order");
+static_assert(BuiltinSensors[0x1B].kind == SensorKind::Status && BuiltinSensors[0x1B].pairedId == 0x0B,
+              "Status IDs must pair with their sensor");
+
+// Sensor descriptors indexed directly by ID. Starts with BuiltinSensors and
+// can be extended from a JSON file at startup; it must not change once
+// acquisition is running.
+class SensorRegistry {
+public:
+    SensorRegistry();
+
+    const SensorDescriptor &operator[](quint8 id) const { return table[id]; }
+    int rowCount() const { return rows; }
+
+    // Value sensors ordered by table row
+    QVector<quint8> valueIds() const;
+
+    // Critical outside [min, max] unless configured otherwise
+    const AlarmLimits &alarmLimits(quint8 id) const { return limits[id]; }
+    // Vibration, 256 points with 75 % overlap and no bands unless configured
+    const SpectrumSettings &spectrumSettings() const { return spectrum; }
+
+    // {"sensors": [{"id": "0x10", "name": "Oil Level", "unit": "L", "min": 0,
+    //   "max": 50, "statusId": "0x20", "gauge": -1,
+    //   "alarm": {"warningHigh": 45, "criticalHigh": 50, "hysteresis": 1,
+    //             "maxRate": 5, "delayMs": 500, "latching": true}}, ...]}
+    // IDs may be numbers or hex strings. An existing ID is replaced but keeps
+    // its error flag unless statusId is given ("0x00" removes it); a new one
+    // gets the next table row. Alarm keys that are left out keep their
+    // default; warningLow and criticalLow work like their High counterparts.
+    // A top-level {"spectrum": {"id": "0x0D", "size": 512, "overlap": 0.5,
+    //   "bands": [{"lowHz": 10, "highHz": 20, "alarm": {...}}]}} replaces
+    // the spectrum settings. Nothing changes when the file has an invalid
+    // entry.
+    bool loadJson(const QString &fileName, QString *error = nullptr);
+
+private:
+    const char *keep(const QString &text);
+
+    SensorTable table;
+    std::array<AlarmLimits, SensorIdCount> limits;
+    SpectrumSettings spectrum;
+    int rows;
+    std::deque<QByteArray> strings; // names and units loaded from JSON
+};
+
+SensorRegistry &sensorRegistry();
+
+#endif // SENSORREGISTRY_H
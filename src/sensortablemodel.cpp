@@ -0,0 +1,193 @@
+#include "sensortablemodel.h"
+#include <QBrush>
+#include <QFont>
+
+SensorTableModel::SensorTableModel(Kind kind, QObject *parent)
+    : QAbstractTableModel(parent), kind(kind), firstChanged(-1), lastChanged(-1), statisticsDirty(false) {
+}
+
+int SensorTableModel::addSensor(const QString &name, double minValue, double maxValue) {
+    const int row = names.size();
+    beginInsertRows(QModelIndex(), row, row);
+    names.append(name);
+    minimum.append(minValue);
+    maximum.append(maxValue);
+    values.append(0);
+    hasValue.append(false);
+    status.append(Unknown);
+    alarms.append(AlarmSeverity::Normal);
+    acknowledged.append(true);
+    statistics.append(SensorStatistics());
+    changed.append(false);
+    endInsertRows();
+    return row;
+}
+
+void SensorTableModel::markChanged(int row, bool statisticsChanged) {
+    changed[row] = true;
+    statisticsDirty = statisticsDirty || statisticsChanged;
+    if (firstChanged < 0 || row < firstChanged)
+        firstChanged = row;
+    if (row > lastChanged)
+        lastChanged = row;
+}
+
+void SensorTableModel::setValue(int row, double value) {
+    if (row < 0 || row >= values.size())
+        return;
+    if (hasValue[row] && values[row] == value)
+        return;
+    values[row] = value;
+    hasValue[row] = true;
+    markChanged(row);
+}
+
+void SensorTableModel::setError(int row, bool error) {
+    if (row < 0 || row >= status.size())
+        return;
+    const qint8 next = error ? Error : Ok;
+    if (status[row] == next)
+        return;
+    status[row] = next;
+    markChanged(row);
+}
+
+void SensorTableModel::setAlarm(int row, AlarmSeverity severity, bool isAcknowledged) {
+    if (row < 0 || row >= alarms.size())
+        return;
+    if (alarms[row] == severity && acknowledged[row] == isAcknowledged)
+        return;
+    alarms[row] = severity;
+    acknowledged[row] = isAcknowledged;
+    markChanged(row);
+}
+
+void SensorTableModel::clearAlarms() {
+    for (int row = 0; row < alarms.size(); ++row)
+        setAlarm(row, AlarmSeverity::Normal, true);
+}
+
+void SensorTableModel::setStatistics(int row, const SensorStatistics &sensor) {
+    if (row < 0 || row >= statistics.size())
+        return;
+    statistics[row] = sensor;
+    markChanged(row, true);
+}
+
+void SensorTableModel::clearStatistics() {
+    for (int row = 0; row < statistics.size(); ++row) {
+        if (statistics[row].count != 0) {
+            statistics[row].count = 0;
+            markChanged(row, true);
+        }
+    }
+}
+
+void SensorTableModel::commit() {
+    if (firstChanged < 0)
+        return;
+    // Only the value column unless the statistics changed too
+    const int lastColumn = statisticsDirty ? columnCount() - 1 : valueColumn();
+    int row = firstChanged;
+    while (row <= lastChanged) {
+        if (!changed[row]) {
+            ++row;
+            continue;
+        }
+        const int first = row;
+        while (row <= lastChanged && changed[row])
+            changed[row++] = false;
+        emit dataChanged(index(first, valueColumn()), index(row - 1, lastColumn));
+    }
+    firstChanged = -1;
+    lastChanged = -1;
+    statisticsDirty = false;
+}
+
+int SensorTableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : names.size();
+}
+
+int SensorTableModel::columnCount(const QModelIndex &parent) const {
+    if (parent.isValid())
+        return 0;
+    return kind == Values ? 12 : 2;
+}
+
+QVariant SensorTableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= names.size())
+        return QVariant();
+    const int row = index.row();
+
+    if (kind == Status && index.column() == 1) {
+        if (status[row] == Unknown)
+            return QVariant();
+        if (role == Qt::DisplayRole)
+            return status[row] == Error ? QStringLiteral("ERROR") : QStringLiteral("OK");
+        if (role == Qt::BackgroundRole)
+            return QBrush(status[row] == Error ? Qt::red : Qt::green);
+        return QVariant();
+    }
+
+    if (kind == Values && index.column() == 3 && alarms[row] != AlarmSeverity::Normal) {
+        if (role == Qt::BackgroundRole)
+            return QBrush(alarms[row] == AlarmSeverity::Critical ? Qt::red : Qt::yellow);
+        if (role == Qt::FontRole && !acknowledged[row]) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+    }
+
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    switch (index.column()) {
+    case 0:
+        return names[row];
+    case 1:
+        return QString::number(minimum[row]);
+    case 2:
+        return QString::number(maximum[row]);
+    case 3:
+        return hasValue[row] ? QString::number(values[row]) : QString();
+    }
+
+    const SensorStatistics &sensor = statistics[row];
+    if (sensor.count == 0)
+        return QVariant();
+    switch (index.column()) {
+    case 4:
+        return QString::number(sensor.count);
+    case 5:
+        return QString::number(sensor.minimum);
+    case 6:
+        return QString::number(sensor.maximum);
+    case 7:
+        return QString::number(sensor.mean);
+    case 8:
+        return QString::number(sensor.standardDeviation);
+    case 9:
+        return QString::number(sensor.p50);
+    case 10:
+        return QString::number(sensor.p95);
+    case 11:
+        return QString::number(sensor.p99);
+    }
+    return QVariant();
+}
+
+QVariant SensorTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    if (orientation == Qt::Vertical)
+        return section + 1;
+
+    static const char *const valueHeaders[] = { "Data", "Min Value", "Max Value", "Value", "Count", "Run Min",
+                                                "Run Max", "Mean", "Std Dev", "P50", "P95", "P99" };
+    static const char *const statusHeaders[] = { "Sensor", "Status" };
+    if (kind == Values && section < 12)
+        return QString::fromLatin1(valueHeaders[section]);
+    if (kind == Status && section < 2)
+        return QString::fromLatin1(statusHeaders[section]);
+    return QVariant();
+}
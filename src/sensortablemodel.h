@@ -0,0 +1,64 @@
+#ifndef SENSORTABLEMODEL_H
+#define SENSORTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include "alarmengine.h"
+#include "runstatistics.h"
+
+// Table model over flat per-sensor arrays. Values shows name, range and the
+// latest value, coloured by its alarm, followed by the run statistics; Status
+// shows name and the error flag. setValue()/setError()
+// only record which rows changed, commit() then emits one dataChanged per
+// run of adjacent changed rows, so the view repaints once per render tick at
+// most and only the rows that changed. The statistics columns are included
+// only when setStatistics()/clearStatistics() were called since the last
+// commit().
+class SensorTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Kind { Values, Status };
+
+    explicit SensorTableModel(Kind kind, QObject *parent = nullptr);
+
+    // Appends a row, returns its index
+    int addSensor(const QString &name, double minValue, double maxValue);
+
+    void setValue(int row, double value);
+    void setError(int row, bool error);
+    // An unacknowledged alarm is shown in bold
+    void setAlarm(int row, AlarmSeverity severity, bool acknowledged);
+    void clearAlarms();
+    // Shown until clearStatistics()
+    void setStatistics(int row, const SensorStatistics &statistics);
+    void clearStatistics();
+    void commit();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    enum StatusValue : qint8 { Unknown = -1, Ok = 0, Error = 1 };
+
+    void markChanged(int row, bool statisticsChanged = false);
+    int valueColumn() const { return kind == Values ? 3 : 1; }
+
+    Kind kind;
+    QVector<QString> names;
+    QVector<double> minimum;
+    QVector<double> maximum;
+    QVector<double> values;
+    QVector<bool> hasValue;
+    QVector<qint8> status;
+    QVector<AlarmSeverity> alarms;
+    QVector<bool> acknowledged;
+    QVector<SensorStatistics> statistics;
+    QVector<bool> changed;
+    int firstChanged;
+    int lastChanged;
+    bool statisticsDirty;
+};
+
+#endif // SENSORTABLEMODEL_H
@@ -1,7 +1,8 @@
 #include "serialhandler.h"
+#include "monotonicclock.h"
 #include <QDebug>
 
-SerialHandler::SerialHandler(QObject *parent) : QObject(parent) {
+SerialHandler::SerialHandler(QObject *parent) : QObject(parent), serialPort(this) {
     connect(&serialPort, &QSerialPort::readyRead, this, &SerialHandler::readData);
 }
 
@@ -14,6 +15,7 @@ bool SerialHandler::openSerialPort(const QString &portName, qint32 baudRate,
     serialPort.setStopBits(stopBits);
 
     if (serialPort.open(QIODevice::ReadOnly)) {
+        reassembler.reset();
         return true;
     } else {
         qWarning() << "Failed to open port" << portName << serialPort.errorString();
@@ -28,6 +30,14 @@ void SerialHandler::closeSerialPort() {
 }
 
 void SerialHandler::readData() {
-    const QByteArray data = serialPort.readAll();
-    emit dataReceived(data);
+    char chunk[1024];
+    qint64 count;
+    while ((count = serialPort.read(chunk, sizeof(chunk))) > 0) {
+        const qint64 arrivalNs = monotonicNanoseconds();
+        reassembler.append(chunk, int(count));
+
+        int frameSize;
+        while ((frameSize = reassembler.nextFrame()) > 0)
+            emit frameReceived(reassembler.frame(), frameSize, arrivalNs);
+    }
 }
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QSerialPort>
 #include <QSerialPortInfo>
+#include "framereassembler.h"
 
 class SerialHandler : public QObject {
     Q_OBJECT
@@ -15,12 +16,16 @@ public:
     void closeSerialPort();
 
 signals:
-    void dataReceived(const QByteArray &data);
+    // frame points into the reassembler and is only valid during emission,
+    // so receivers must be connected directly. arrivalNs is the monotonic
+    // time of the read that completed the frame.
+    void frameReceived(const quint8 *frame, int size, qint64 arrivalNs);
 
 private slots:
     void readData();
 
 private:
     QSerialPort serialPort;
+    FrameReassembler reassembler;
 };
 #endif // SERIALHANDLER_H
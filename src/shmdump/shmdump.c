@@ -0,0 +1,74 @@
+/*
+ * Prints the latest values the monitor publishes in shared memory. Written
+ * against emsshm.h only, as an example for other local readers.
+ *
+ *   shmdump [name] [interval_ms]
+ *
+ * name defaults to EMS_SHM_NAME; with an interval the table is printed
+ * again every interval_ms until interrupted.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "emsshm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+static void print_segment(const ems_shm_segment *segment)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const int64_t now_ns = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+
+    printf("port %u, pid %d, %llu frames\n", segment->header.source + 1, segment->header.writer_pid,
+           (unsigned long long)ems_shm_frames(segment));
+    for (int id = 0; id < EMS_SHM_SENSOR_COUNT; ++id) {
+        ems_shm_sensor sensor;
+        if (segment->sensors[id].kind != EMS_SHM_VALUE || !ems_shm_read(segment, (uint8_t)id, &sensor))
+            continue;
+        if (sensor.time_ns == 0) {
+            printf("  0x%02X  no data\n", id);
+            continue;
+        }
+        printf("  0x%02X  %14.6g%s  %8.1f ms ago  %llu updates\n", id, sensor.value, sensor.error ? " ERROR" : "",
+               (now_ns - sensor.time_ns) / 1e6, (unsigned long long)sensor.updates);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *name = argc > 1 ? argv[1] : EMS_SHM_NAME;
+    const long interval_ms = argc > 2 ? strtol(argv[2], NULL, 10) : 0;
+
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", name, strerror(errno));
+        return 1;
+    }
+    const ems_shm_segment *segment = mmap(NULL, sizeof(ems_shm_segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s: %s\n", name, strerror(errno));
+        return 1;
+    }
+    if (!ems_shm_valid(segment)) {
+        fprintf(stderr, "%s is not a latest-value segment of this version\n", name);
+        return 1;
+    }
+
+    for (;;) {
+        print_segment(segment);
+        if (interval_ms <= 0)
+            break;
+        const struct timespec delay = { interval_ms / 1000, (interval_ms % 1000) * 1000000 };
+        nanosleep(&delay, NULL);
+    }
+    munmap((void *)segment, sizeof(ems_shm_segment));
+    return 0;
+}
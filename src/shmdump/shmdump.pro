@@ -0,0 +1,17 @@
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle qt
+
+TARGET = shmdump
+
+# Only needs the C layout header, like any other reader would
+INCLUDEPATH += ..
+
+SOURCES += \
+    shmdump.c
+
+HEADERS += \
+    ../emsshm.h
+
+linux: LIBS += -lrt
@@ -0,0 +1,274 @@
+#include "spectrumanalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(Q_PROCESSOR_X86) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+#  define SPECTRUM_X86
+#  include <immintrin.h>
+#endif
+
+// x = (x - mean) * w
+static void windowScalar(float *x, const float *w, float mean, int count) {
+    for (int i = 0; i < count; ++i)
+        x[i] = (x[i] - mean) * w[i];
+}
+
+// count radix-2 butterflies between a and b = a + half
+static void butterflyScalar(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi, int count) {
+    for (int k = 0; k < count; ++k) {
+        const float tr = br[k] * wr[k] - bi[k] * wi[k];
+        const float ti = br[k] * wi[k] + bi[k] * wr[k];
+        br[k] = ar[k] - tr;
+        bi[k] = ai[k] - ti;
+        ar[k] += tr;
+        ai[k] += ti;
+    }
+}
+
+static void magnitudeScalar(const float *re, const float *im, float scale, float *out, int count) {
+    for (int k = 0; k < count; ++k)
+        out[k] = std::sqrt(re[k] * re[k] + im[k] * im[k]) * scale;
+}
+
+#ifdef SPECTRUM_X86
+
+__attribute__((target("sse2")))
+static void windowSse2(float *x, const float *w, float mean, int count) {
+    const __m128 offset = _mm_set1_ps(mean);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(x + i, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x + i), offset), _mm_loadu_ps(w + i)));
+    for (; i < count; ++i)
+        x[i] = (x[i] - mean) * w[i];
+}
+
+__attribute__((target("sse2")))
+static void butterflySse2(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi, int count) {
+    for (int k = 0; k < count; k += 4) {
+        const __m128 xr = _mm_loadu_ps(br + k);
+        const __m128 xi = _mm_loadu_ps(bi + k);
+        const __m128 cr = _mm_loadu_ps(wr + k);
+        const __m128 ci = _mm_loadu_ps(wi + k);
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, cr), _mm_mul_ps(xi, ci));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, ci), _mm_mul_ps(xi, cr));
+        const __m128 yr = _mm_loadu_ps(ar + k);
+        const __m128 yi = _mm_loadu_ps(ai + k);
+        _mm_storeu_ps(br + k, _mm_sub_ps(yr, tr));
+        _mm_storeu_ps(bi + k, _mm_sub_ps(yi, ti));
+        _mm_storeu_ps(ar + k, _mm_add_ps(yr, tr));
+        _mm_storeu_ps(ai + k, _mm_add_ps(yi, ti));
+    }
+}
+
+__attribute__((target("sse2")))
+static void magnitudeSse2(const float *re, const float *im, float scale, float *out, int count) {
+    const __m128 factor = _mm_set1_ps(scale);
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        const __m128 xr = _mm_loadu_ps(re + k);
+        const __m128 xi = _mm_loadu_ps(im + k);
+        _mm_storeu_ps(out + k, _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(xr, xr), _mm_mul_ps(xi, xi))), factor));
+    }
+    for (; k < count; ++k)
+        out[k] = std::sqrt(re[k] * re[k] + im[k] * im[k]) * scale;
+}
+
+__attribute__((target("avx")))
+static void windowAvx(float *x, const float *w, float mean, int count) {
+    const __m256 offset = _mm256_set1_ps(mean);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), offset), _mm256_loadu_ps(w + i)));
+    for (; i < count; ++i)
+        x[i] = (x[i] - mean) * w[i];
+}
+
+__attribute__((target("avx")))
+static void butterflyAvx(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi, int count) {
+    for (int k = 0; k < count; k += 8) {
+        const __m256 xr = _mm256_loadu_ps(br + k);
+        const __m256 xi = _mm256_loadu_ps(bi + k);
+        const __m256 cr = _mm256_loadu_ps(wr + k);
+        const __m256 ci = _mm256_loadu_ps(wi + k);
+        const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(xr, cr), _mm256_mul_ps(xi, ci));
+        const __m256 ti = _mm256_add_ps(_mm256_mul_ps(xr, ci), _mm256_mul_ps(xi, cr));
+        const __m256 yr = _mm256_loadu_ps(ar + k);
+        const __m256 yi = _mm256_loadu_ps(ai + k);
+        _mm256_storeu_ps(br + k, _mm256_sub_ps(yr, tr));
+        _mm256_storeu_ps(bi + k, _mm256_sub_ps(yi, ti));
+        _mm256_storeu_ps(ar + k, _mm256_add_ps(yr, tr));
+        _mm256_storeu_ps(ai + k, _mm256_add_ps(yi, ti));
+    }
+}
+
+__attribute__((target("avx")))
+static void magnitudeAvx(const float *re, const float *im, float scale, float *out, int count) {
+    const __m256 factor = _mm256_set1_ps(scale);
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        const __m256 xr = _mm256_loadu_ps(re + k);
+        const __m256 xi = _mm256_loadu_ps(im + k);
+        _mm256_storeu_ps(out + k, _mm256_mul_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(xr, xr), _mm256_mul_ps(xi, xi))), factor));
+    }
+    for (; k < count; ++k)
+        out[k] = std::sqrt(re[k] * re[k] + im[k] * im[k]) * scale;
+}
+
+#endif // SPECTRUM_X86
+
+namespace {
+
+struct SpectrumKernels {
+    void (*window)(float *, const float *, float, int);
+    // Takes whole vectors only; shorter stages use butterflyScalar
+    void (*butterfly)(float *, float *, float *, float *, const float *, const float *, int);
+    void (*magnitude)(const float *, const float *, float, float *, int);
+    int width;
+    const char *name;
+};
+
+SpectrumKernels selectKernels() {
+#ifdef SPECTRUM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+        return { windowAvx, butterflyAvx, magnitudeAvx, 8, "avx" };
+    if (__builtin_cpu_supports("sse2"))
+        return { windowSse2, butterflySse2, magnitudeSse2, 4, "sse2" };
+#endif
+    return { windowScalar, butterflyScalar, magnitudeScalar, 1, "scalar" };
+}
+
+const SpectrumKernels &kernels() {
+    static const SpectrumKernels selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+SpectrumAnalyzer::SpectrumAnalyzer(int size, int hop) {
+    n = roundedSize(size);
+    hopSize = qBound(1, hop, n);
+    bits = 0;
+    while ((1 << bits) < n)
+        ++bits;
+
+    window.resize(n);
+    windowGain = 0;
+    for (int i = 0; i < n; ++i) {
+        window[i] = float(0.5 - 0.5 * std::cos(2 * M_PI * i / n));
+        windowGain += window[i];
+    }
+
+    twiddleRe.resize(n - 1);
+    twiddleIm.resize(n - 1);
+    for (int half = 1; half < n; half *= 2) {
+        for (int k = 0; k < half; ++k) {
+            const double angle = -M_PI * k / half;
+            twiddleRe[half - 1 + k] = float(std::cos(angle));
+            twiddleIm[half - 1 + k] = float(std::sin(angle));
+        }
+    }
+
+    bitReverse.resize(n);
+    for (int i = 0; i < n; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b)
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        bitReverse[i] = reversed;
+    }
+
+    samples.resize(n);
+    times.resize(n);
+    ordered.resize(n);
+    re.resize(n);
+    im.resize(n);
+    magnitude.resize(binCount());
+    reset();
+}
+
+int SpectrumAnalyzer::roundedSize(int size) {
+    int rounded = MinSize;
+    while (rounded * 2 <= qMin(size, int(MaxSize)))
+        rounded *= 2;
+    return rounded;
+}
+
+const char *SpectrumAnalyzer::kernel() {
+    return kernels().name;
+}
+
+void SpectrumAnalyzer::reset() {
+    samples.fill(0);
+    times.fill(0);
+    magnitude.fill(0);
+    rate = 0;
+    head = 0;
+    filled = 0;
+    sinceLast = 0;
+}
+
+bool SpectrumAnalyzer::push(qint64 timeNs, float value) {
+    samples[head] = value;
+    times[head] = timeNs;
+    head = (head + 1) & (n - 1);
+    if (filled < n)
+        ++filled;
+    if (++sinceLast < hopSize || filled < n)
+        return false;
+    sinceLast = 0;
+    transform();
+    return true;
+}
+
+void SpectrumAnalyzer::transform() {
+    const SpectrumKernels &k = kernels();
+    const qint64 spanNs = times[(head - 1) & (n - 1)] - times[head];
+    rate = spanNs > 0 ? float((n - 1) * 1e9 / double(spanNs)) : 0;
+    const float *input = samples.constData();
+    float mean = 0;
+    for (int i = 0; i < n; ++i)
+        mean += input[i];
+    mean /= n;
+
+    // Oldest sample is at head: unwrap, remove the offset and window in
+    // contiguous order, then scatter into bit-reversed order
+    float *x = ordered.data();
+    memcpy(x, input + head, (n - head) * sizeof(float));
+    memcpy(x + n - head, input, head * sizeof(float));
+    k.window(x, window.constData(), mean, n);
+
+    const int *reverse = bitReverse.constData();
+    float *xr = re.data();
+    float *xi = im.data();
+    for (int i = 0; i < n; ++i)
+        xr[reverse[i]] = x[i];
+    std::fill(xi, xi + n, 0.0f);
+
+    for (int half = 1; half < n; half *= 2) {
+        const float *wr = twiddleRe.constData() + half - 1;
+        const float *wi = twiddleIm.constData() + half - 1;
+        const auto butterfly = half >= k.width ? k.butterfly : butterflyScalar;
+        for (int start = 0; start < n; start += 2 * half)
+            butterfly(xr + start, xi + start, xr + start + half, xi + start + half, wr, wi, half);
+    }
+
+    // One-sided amplitude: DC and Nyquist are not doubled
+    const int bins = binCount();
+    float *out = magnitude.data();
+    k.magnitude(xr, xi, 2 / windowGain, out, bins);
+    out[0] *= 0.5f;
+    out[bins - 1] *= 0.5f;
+}
+
+float SpectrumAnalyzer::bandRms(float lowHz, float highHz) const {
+    if (rate <= 0)
+        return 0;
+    const int first = qMax(0, int(std::ceil(lowHz * n / rate)));
+    const int last = qMin(binCount(), int(std::ceil(highHz * n / rate)));
+    // A Hann window spreads a tone over bins; 1.5 is its noise bandwidth
+    double sum = 0;
+    for (int k = first; k < last; ++k)
+        sum += double(magnitude[k]) * magnitude[k];
+    return float(std::sqrt(sum / 2 / 1.5));
+}
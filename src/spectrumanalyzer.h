@@ -0,0 +1,67 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QtGlobal>
+#include <QVector>
+
+// Sliding-window amplitude spectrum of one sample stream.
+//
+// Samples go into a ring of size() entries; every hop() samples the ring
+// is unwrapped, loses its mean, is Hann-windowed and is transformed with a
+// radix-2 FFT. Real and imaginary parts are kept in separate arrays and every
+// stage reads its own contiguous twiddle table. The window, butterfly and
+// magnitude loops are SSE2 or AVX kernels picked once at startup from what
+// the CPU supports, like the frame scan; other platforms use the scalar
+// code. Nothing is allocated after construction.
+class SpectrumAnalyzer {
+public:
+    static const int MinSize = 16;
+    static const int MaxSize = 4096;
+
+    // size is rounded down to a power of two within [MinSize, MaxSize]
+    explicit SpectrumAnalyzer(int size = 256, int hop = 64);
+    static int roundedSize(int size);
+    // Name of the kernel chosen at runtime ("avx", "sse2" or "scalar")
+    static const char *kernel();
+
+    int size() const { return n; }
+    int hop() const { return hopSize; }
+    int binCount() const { return n / 2 + 1; }
+    void reset();
+
+    // Returns true when a new spectrum is ready in amplitude()
+    bool push(qint64 timeNs, float value);
+
+    // Peak amplitude of a sinusoid at each bin, in the sample's unit
+    const float *amplitude() const { return magnitude.constData(); }
+    // Rate of the samples in the last window, 0 until one was transformed
+    float sampleRate() const { return rate; }
+    float binFrequency(int bin) const { return rate * bin / n; }
+
+    // RMS of the band [lowHz, highHz) in the last spectrum
+    float bandRms(float lowHz, float highHz) const;
+
+private:
+    void transform();
+
+    int n;
+    int hopSize;
+    int bits;
+    QVector<float> window;
+    QVector<float> twiddleRe; // stage with half-length h starts at h - 1
+    QVector<float> twiddleIm;
+    QVector<int> bitReverse;
+    QVector<float> samples;   // ring
+    QVector<qint64> times;
+    QVector<float> ordered;   // ring unwrapped, oldest first
+    QVector<float> re;
+    QVector<float> im;
+    QVector<float> magnitude;
+    float windowGain;
+    float rate;
+    int head;
+    int filled;
+    int sinceLast;
+};
+
+#endif // SPECTRUMANALYZER_H
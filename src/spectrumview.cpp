@@ -0,0 +1,95 @@
+#include "spectrumview.h"
+#include <QPainter>
+#include <QPainterPath>
+
+static const int Margin = 30;
+
+SpectrumView::SpectrumView(QWidget *parent)
+    : QWidget(parent), sampleRate(0), scaleMax(0) {
+    setMinimumSize(200, 120);
+}
+
+void SpectrumView::setSettings(const SpectrumSettings &spectrumSettings, const QString &sensorName) {
+    settings = spectrumSettings;
+    name = sensorName;
+    update();
+}
+
+void SpectrumView::setSpectrum(const Spectrum &spectrum) {
+    amplitude.resize(spectrum.binCount);
+    float peak = 0;
+    for (int k = 0; k < spectrum.binCount; ++k) {
+        amplitude[k] = spectrum.amplitude[k];
+        peak = qMax(peak, spectrum.amplitude[k]);
+    }
+    bandRms.resize(spectrum.bandCount);
+    bandSeverity.resize(spectrum.bandCount);
+    bandAcknowledged.resize(spectrum.bandCount);
+    for (int band = 0; band < spectrum.bandCount; ++band) {
+        bandRms[band] = spectrum.bandRms[band];
+        bandSeverity[band] = spectrum.bandSeverity[band];
+        bandAcknowledged[band] = spectrum.bandAcknowledged[band];
+    }
+    sampleRate = spectrum.sampleRate;
+    scaleMax = qMax(peak, scaleMax * 0.98f);
+    update();
+}
+
+void SpectrumView::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(20, 20, 24));
+    const QRect plot = rect().adjusted(Margin, Margin, -10, -Margin);
+    painter.setPen(palette().light().color());
+    if (amplitude.size() < 2 || sampleRate <= 0 || plot.width() <= 0) {
+        painter.drawText(rect(), Qt::AlignCenter, QString("Waiting for %1 samples").arg(name));
+        return;
+    }
+
+    const float nyquist = sampleRate / 2;
+    auto xOf = [&](float hz) { return plot.left() + plot.width() * qBound(0.0f, hz / nyquist, 1.0f); };
+    const float top = scaleMax > 0 ? scaleMax * 1.1f : 1;
+    auto yOf = [&](float value) { return plot.bottom() - plot.height() * qBound(0.0f, value / top, 1.0f); };
+
+    // Bands behind the spectrum
+    for (int band = 0; band < bandRms.size() && band < settings.bands.size(); ++band) {
+        const SpectrumBand &range = settings.bands[band];
+        QColor color(80, 80, 96);
+        if (bandSeverity[band] == AlarmSeverity::Critical)
+            color = Qt::red;
+        else if (bandSeverity[band] == AlarmSeverity::Warning)
+            color = Qt::yellow;
+        color.setAlpha(bandAcknowledged[band] ? 50 : 110);
+        const QRectF area(QPointF(xOf(range.lowHz), plot.top()), QPointF(xOf(range.highHz), plot.bottom()));
+        painter.fillRect(area, color);
+        painter.drawText(area.adjusted(2, 2, 0, 0), Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap,
+                         QString("%1-%2 Hz\n%3 RMS").arg(double(range.lowHz)).arg(double(range.highHz)).arg(double(bandRms[band]), 0, 'g', 3));
+    }
+
+    QPainterPath path;
+    int peak = 1;
+    for (int k = 0; k < amplitude.size(); ++k) {
+        const QPointF point(xOf(sampleRate * k / (2 * (amplitude.size() - 1))), yOf(amplitude[k]));
+        if (k == 0)
+            path.moveTo(point);
+        else
+            path.lineTo(point);
+        if (k > 0 && amplitude[k] > amplitude[peak])
+            peak = k;
+    }
+    painter.setPen(QColor(90, 200, 250));
+    painter.drawPath(path);
+
+    painter.setPen(palette().light().color());
+    painter.drawRect(plot);
+    painter.drawText(plot.left(), plot.bottom() + 18, "0 Hz");
+    const QString end = QString("%1 Hz").arg(double(nyquist), 0, 'f', 1);
+    painter.drawText(plot.right() - painter.fontMetrics().horizontalAdvance(end), plot.bottom() + 18, end);
+    const float peakHz = sampleRate * peak / (2 * (amplitude.size() - 1));
+    painter.drawText(plot.left(), plot.top() - 8,
+                     QString("%1 spectrum, %2 samples/s, peak %3 at %4 Hz, scale %5")
+                         .arg(name)
+                         .arg(double(sampleRate), 0, 'f', 1)
+                         .arg(double(amplitude[peak]), 0, 'g', 3)
+                         .arg(double(peakHz), 0, 'f', 2)
+                         .arg(double(top), 0, 'g', 3));
+}
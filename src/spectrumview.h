@@ -0,0 +1,33 @@
+#ifndef SPECTRUMVIEW_H
+#define SPECTRUMVIEW_H
+
+#include <QVector>
+#include <QWidget>
+#include "spectrumworker.h"
+
+// Amplitude spectrum of the analysed sensor with its bands shaded by alarm
+// state. The amplitude axis follows the peak and decays slowly, so a
+// transient stays readable for a few seconds.
+class SpectrumView : public QWidget {
+    Q_OBJECT
+public:
+    explicit SpectrumView(QWidget *parent = nullptr);
+
+    void setSettings(const SpectrumSettings &settings, const QString &sensorName);
+    void setSpectrum(const Spectrum &spectrum);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    SpectrumSettings settings;
+    QString name;
+    QVector<float> amplitude;
+    QVector<float> bandRms;
+    QVector<AlarmSeverity> bandSeverity;
+    QVector<bool> bandAcknowledged;
+    float sampleRate;
+    float scaleMax;
+};
+
+#endif // SPECTRUMVIEW_H
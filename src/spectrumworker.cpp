@@ -0,0 +1,84 @@
+#include "spectrumworker.h"
+#include "monotonicclock.h"
+#include <cstring>
+
+// The overlap applies to the window actually used, after rounding
+static int hopSize(const SpectrumSettings &settings) {
+    return qMax(1, int(SpectrumAnalyzer::roundedSize(settings.size) * (1 - settings.overlap)));
+}
+
+SpectrumWorker::SpectrumWorker(const SpectrumSettings &spectrumSettings, QObject *parent)
+    : QObject(parent), settings(spectrumSettings), analyzer(spectrumSettings.size, hopSize(spectrumSettings)),
+      alarmLogQueue(nullptr), drainTimer(new QTimer(this)), displayEnabled(true) {
+    settings.bands.resize(qMin(settings.bands.size(), int(SpectrumSettings::MaxBands)));
+    for (int band = 0; band < settings.bands.size(); ++band)
+        alarms.setLimits(quint8(band), settings.bands[band].limits);
+    memset(&spectrum, 0, sizeof(spectrum));
+    drainTimer->setInterval(DrainIntervalMs);
+    connect(drainTimer, &QTimer::timeout, this, &SpectrumWorker::drain);
+}
+
+void SpectrumWorker::start() {
+    // Samples queued while stopped belong to no run
+    TimedSample sample;
+    while (samples.pop(sample)) {
+    }
+    analyzer.reset();
+    alarms.reset();
+    drainTimer->start();
+}
+
+void SpectrumWorker::stop() {
+    drainTimer->stop();
+    drain();
+}
+
+void SpectrumWorker::drain() {
+    TimedSample sample;
+    while (samples.pop(sample)) {
+        if (analyzer.push(sample.timeNs, sample.value))
+            analyse(sample.timeNs);
+    }
+}
+
+void SpectrumWorker::analyse(qint64 timeNs) {
+    spectrum.timeNs = timeNs;
+    spectrum.sampleRate = analyzer.sampleRate();
+    spectrum.binCount = analyzer.binCount();
+    spectrum.bandCount = settings.bands.size();
+    memcpy(spectrum.amplitude, analyzer.amplitude(), sizeof(float) * size_t(spectrum.binCount));
+
+    AlarmEvent event;
+    for (int band = 0; band < spectrum.bandCount; ++band) {
+        const SpectrumBand &range = settings.bands[band];
+        const float rms = analyzer.bandRms(range.lowHz, range.highHz);
+        spectrum.bandRms[band] = rms;
+        if (alarms.evaluate(quint8(band), timeNs, rms, event) && alarmLogQueue) {
+            event.id = settings.id;
+            event.band = quint8(band + 1);
+            alarmLogQueue->push(event);
+        }
+        spectrum.bandSeverity[band] = alarms.severity(quint8(band));
+        spectrum.bandAcknowledged[band] = alarms.isAcknowledged(quint8(band));
+    }
+
+    // The GUI only shows the newest spectrum, so a full queue just skips one
+    if (displayEnabled)
+        results.push(spectrum);
+}
+
+void SpectrumWorker::acknowledgeAlarms() {
+    const qint64 now = monotonicNanoseconds();
+    AlarmEvent event;
+    for (int band = 0; band < settings.bands.size(); ++band) {
+        if (alarms.acknowledge(quint8(band), now, event) && alarmLogQueue) {
+            event.id = settings.id;
+            event.band = quint8(band + 1);
+            alarmLogQueue->push(event);
+        }
+        spectrum.bandSeverity[band] = alarms.severity(quint8(band));
+        spectrum.bandAcknowledged[band] = alarms.isAcknowledged(quint8(band));
+    }
+    if (displayEnabled && spectrum.binCount > 0)
+        results.push(spectrum);
+}
@@ -0,0 +1,77 @@
+#ifndef SPECTRUMWORKER_H
+#define SPECTRUMWORKER_H
+
+#include <QObject>
+#include <QTimer>
+#include "alarmengine.h"
+#include "sensorregistry.h"
+#include "spectrumanalyzer.h"
+#include "spscqueue.h"
+
+struct TimedSample {
+    qint64 timeNs;
+    float value;
+};
+
+typedef SpscQueue<TimedSample, 8192> TimedSampleQueue;
+
+// One analysed window, as handed to the GUI
+struct Spectrum {
+    static const int MaxBins = SpectrumAnalyzer::MaxSize / 2 + 1;
+
+    qint64 timeNs; // newest sample in the window
+    float sampleRate;
+    int binCount;
+    int bandCount;
+    float amplitude[MaxBins];
+    float bandRms[SpectrumSettings::MaxBands];
+    AlarmSeverity bandSeverity[SpectrumSettings::MaxBands];
+    bool bandAcknowledged[SpectrumSettings::MaxBands];
+};
+
+typedef SpscQueue<Spectrum, 4> SpectrumQueue;
+
+// Runs the spectrum analysis of one sensor on its own thread. The
+// acquisition worker only copies the sensor's samples into queue(); the
+// FFT, band RMS and band alarms happen here, so acquisition never waits for
+// them. Band alarm events are pushed to the alarm log queue.
+class SpectrumWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit SpectrumWorker(const SpectrumSettings &settings, QObject *parent = nullptr);
+
+    quint8 sensorId() const { return settings.id; }
+    const SpectrumSettings &spectrumSettings() const { return settings; }
+
+    TimedSampleQueue &queue() { return samples; }
+    // Off when nothing drains spectra(), e.g. without a GUI
+    SpectrumQueue &spectra() { return results; }
+    void setDisplayQueueEnabled(bool enabled) { displayEnabled = enabled; }
+    // Set before the thread starts
+    void setAlarmLogQueue(AlarmEventQueue *queue) { alarmLogQueue = queue; }
+
+    // Must be called on the worker's thread
+    void start();
+    void stop();
+    void acknowledgeAlarms();
+
+private slots:
+    void drain();
+
+private:
+    static const int DrainIntervalMs = 10;
+
+    void analyse(qint64 timeNs);
+
+    SpectrumSettings settings;
+    SpectrumAnalyzer analyzer;
+    AlarmEngine alarms;
+    TimedSampleQueue samples;
+    SpectrumQueue results;
+    AlarmEventQueue *alarmLogQueue;
+    Spectrum spectrum;
+    QTimer *drainTimer;
+    bool displayEnabled;
+};
+
+#endif // SPECTRUMWORKER_H
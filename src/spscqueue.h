@@ -0,0 +1,61 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Bounded single-producer/single-consumer queue.
+//
+// One thread may call push(), one other thread may call pop(); neither ever
+// blocks or takes a lock. Head and tail sit on separate cache lines and each
+// side keeps a private copy of the other index so that the shared atomics are
+// only touched when the cached value says the queue looks full or empty.
+template <typename T, int Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0), cachedTail(0), cachedHead(0) {}
+
+    bool push(const T &item) {
+        const quint32 h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail == quint32(Capacity)) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail == quint32(Capacity))
+                return false;
+        }
+        items[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item) {
+        const quint32 t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead)
+                return false;
+        }
+        item = items[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is running
+    int size() const {
+        return int(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+
+    static constexpr int capacity() { return Capacity; }
+
+private:
+    Q_DISABLE_COPY(SpscQueue)
+
+    alignas(64) std::atomic<quint32> head;
+    alignas(64) std::atomic<quint32> tail;
+    alignas(64) quint32 cachedTail; // producer side
+    alignas(64) quint32 cachedHead; // consumer side
+    T items[Capacity];
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,101 @@
+#include "telemetrypacket.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QNetworkDatagram>
+#include <QTextStream>
+#include <QTimer>
+#include <QUdpSocket>
+
+// Receives the monitor's telemetry datagrams and reports what arrived, so
+// that publishing can be checked over loopback or on the cell network.
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("telemetrydump");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Receives engine monitor telemetry datagrams.");
+    parser.addHelpOption();
+    QCommandLineOption portOption({ "p", "port" }, "UDP port to listen on.", "port", "5005");
+    QCommandLineOption groupOption({ "g", "group" }, "Multicast group to join.", "address");
+    QCommandLineOption samplesOption({ "s", "samples" }, "Print every sample, not only the per-second summary.");
+    parser.addOptions({ portOption, groupOption, samplesOption });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QHostAddress group(parser.value(groupOption));
+    const bool ipv6 = group.protocol() == QAbstractSocket::IPv6Protocol;
+    QUdpSocket socket;
+    if (!socket.bind(ipv6 ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4, parser.value(portOption).toUShort(),
+                     QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
+        err << "Cannot listen on port " << parser.value(portOption) << ": " << socket.errorString() << Qt::endl;
+        return 1;
+    }
+    if (parser.isSet(groupOption) && !socket.joinMulticastGroup(group)) {
+        err << "Cannot join " << parser.value(groupOption) << ": " << socket.errorString() << Qt::endl;
+        return 1;
+    }
+
+    const bool printSamples = parser.isSet(samplesOption);
+    TelemetryPacket packet;
+    bool first = true;
+    quint32 expected = 0;
+    qint64 datagrams = 0;
+    qint64 samples = 0;
+    qint64 lost = 0;
+    qint64 reordered = 0;
+    qint64 invalid = 0;
+    qint64 worstDelayUs = 0;
+
+    QObject::connect(&socket, &QUdpSocket::readyRead, &app, [&]() {
+        while (socket.hasPendingDatagrams()) {
+            const QNetworkDatagram datagram = socket.receiveDatagram();
+            const QByteArray data = datagram.data();
+            if (!decodeTelemetryPacket(data.constData(), data.size(), packet)) {
+                ++invalid;
+                continue;
+            }
+
+            // A new run starts again at sequence 0
+            if (first || packet.sequence == 0) {
+                first = false;
+            } else if (packet.sequence > expected) {
+                lost += packet.sequence - expected;
+            } else if (packet.sequence < expected) {
+                ++reordered;
+            }
+            if (packet.sequence >= expected || packet.sequence == 0)
+                expected = packet.sequence + 1;
+
+            ++datagrams;
+            samples += packet.samples.size();
+            // Wall clocks of sender and receiver agree on loopback
+            worstDelayUs = qMax(worstDelayUs, QDateTime::currentMSecsSinceEpoch() * 1000 - packet.baseUtcUs);
+
+            if (printSamples) {
+                for (const TelemetrySample &sample : packet.samples) {
+                    const qint64 utcUs = packet.baseUtcUs + (sample.timeNs - packet.baseNs) / 1000;
+                    out << packet.sequence << ',' << QDateTime::fromMSecsSinceEpoch(utcUs / 1000).toString(Qt::ISODateWithMs)
+                        << ',' << sample.source + 1 << ",0x" << QString::number(sample.id, 16).rightJustified(2, '0')
+                        << ',' << QString::number(sample.value, 'g', 10) << '\n';
+                }
+                out.flush();
+            }
+        }
+    });
+
+    QTimer reportTimer;
+    QObject::connect(&reportTimer, &QTimer::timeout, &app, [&]() {
+        if (datagrams > 0 || invalid > 0)
+            err << datagrams << " datagrams/s, " << samples << " samples/s, " << lost << " lost, " << reordered
+                << " reordered, " << invalid << " invalid, oldest sample " << worstDelayUs / 1000 << " ms old" << Qt::endl;
+        datagrams = samples = lost = reordered = invalid = worstDelayUs = 0;
+    });
+    reportTimer.start(1000);
+
+    return app.exec();
+}
@@ -0,0 +1,16 @@
+QT = core network
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = telemetrydump
+
+# Shares the datagram format with the monitor
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    ../telemetrypacket.cpp
+
+HEADERS += \
+    ../telemetrypacket.h
@@ -0,0 +1,66 @@
+#include "telemetrypacket.h"
+#include <QtEndian>
+#include <cstdint>
+#include <cstring>
+
+TelemetryPacketWriter::TelemetryPacketWriter() : baseNs(0), samples(0) {
+    memset(buffer, 0, sizeof(buffer));
+}
+
+void TelemetryPacketWriter::begin(quint32 sequence, qint64 firstNs, qint64 baseUtcUs) {
+    baseNs = firstNs;
+    samples = 0;
+    uchar *header = reinterpret_cast<uchar *>(buffer);
+    memcpy(header, TelemetryMagic, sizeof(TelemetryMagic));
+    header[4] = TelemetryVersion;
+    header[5] = 0;
+    qToBigEndian<quint16>(0, header + 6);
+    qToBigEndian<quint32>(sequence, header + 8);
+    qToBigEndian<qint64>(baseUtcUs, header + 12);
+    qToBigEndian<qint64>(baseNs, header + 20);
+}
+
+bool TelemetryPacketWriter::add(qint64 timeNs, quint8 source, quint8 id, double value) {
+    // Sources are drained one after another, so offsets can be negative
+    const qint64 offsetUs = (timeNs - baseNs) / 1000;
+    if (samples == MaxSamples || offsetUs < INT32_MIN || offsetUs > INT32_MAX)
+        return false;
+
+    uchar *sample = reinterpret_cast<uchar *>(buffer) + HeaderSize + samples * SampleSize;
+    qToBigEndian<qint32>(qint32(offsetUs), sample);
+    sample[4] = source;
+    sample[5] = id;
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToBigEndian<quint64>(bits, sample + 6);
+    ++samples;
+    qToBigEndian<quint16>(quint16(samples), reinterpret_cast<uchar *>(buffer) + 6);
+    return true;
+}
+
+bool decodeTelemetryPacket(const char *data, int size, TelemetryPacket &packet) {
+    const uchar *header = reinterpret_cast<const uchar *>(data);
+    if (size < TelemetryPacketWriter::HeaderSize || memcmp(header, TelemetryMagic, sizeof(TelemetryMagic)) != 0
+        || header[4] != TelemetryVersion)
+        return false;
+
+    const int count = qFromBigEndian<quint16>(header + 6);
+    if (size != TelemetryPacketWriter::HeaderSize + count * TelemetryPacketWriter::SampleSize)
+        return false;
+
+    packet.sequence = qFromBigEndian<quint32>(header + 8);
+    packet.baseUtcUs = qFromBigEndian<qint64>(header + 12);
+    packet.baseNs = qFromBigEndian<qint64>(header + 20);
+    packet.samples.resize(count);
+
+    const uchar *sample = header + TelemetryPacketWriter::HeaderSize;
+    for (int i = 0; i < count; ++i, sample += TelemetryPacketWriter::SampleSize) {
+        TelemetrySample &out = packet.samples[i];
+        out.timeNs = packet.baseNs + qint64(qFromBigEndian<qint32>(sample)) * 1000;
+        out.source = sample[4];
+        out.id = sample[5];
+        const quint64 bits = qFromBigEndian<quint64>(sample + 6);
+        memcpy(&out.value, &bits, sizeof(bits));
+    }
+    return true;
+}
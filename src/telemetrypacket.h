@@ -0,0 +1,65 @@
+#ifndef TELEMETRYPACKET_H
+#define TELEMETRYPACKET_H
+
+#include <QtGlobal>
+#include <QVector>
+
+// Telemetry datagram.
+//
+// Layout (big-endian, packed):
+//   header  magic "EMST", version u8, flags u8, sampleCount u16,
+//           sequence u32, baseUtcUs i64, baseNs i64
+//   samples offsetUs i32, source u8, id u8, value f64 (IEEE 754)
+//
+// baseNs is the monotonic arrival time of the first sample, baseUtcUs the
+// same instant on the wall clock. Each sample arrived offsetUs after it.
+// The sequence number counts datagrams of a run, so receivers can detect
+// loss and reordering. A datagram never exceeds MaxDatagramSize, which fits
+// a 1500 byte Ethernet MTU without fragmentation.
+
+static const char TelemetryMagic[4] = { 'E', 'M', 'S', 'T' };
+static const quint8 TelemetryVersion = 1;
+
+struct TelemetrySample {
+    qint64 timeNs; // monotonic, on the sender's clock
+    quint8 source;
+    quint8 id;
+    double value;
+};
+
+struct TelemetryPacket {
+    quint32 sequence;
+    qint64 baseUtcUs;
+    qint64 baseNs;
+    QVector<TelemetrySample> samples;
+};
+
+// Builds one datagram in a fixed buffer; nothing is allocated
+class TelemetryPacketWriter {
+public:
+    static const int MaxDatagramSize = 1472;
+    static const int HeaderSize = 28;
+    static const int SampleSize = 14;
+    static const int MaxSamples = (MaxDatagramSize - HeaderSize) / SampleSize;
+
+    TelemetryPacketWriter();
+
+    void begin(quint32 sequence, qint64 baseNs, qint64 baseUtcUs);
+    // False when the datagram is full or timeNs is too far from its base
+    bool add(qint64 timeNs, quint8 source, quint8 id, double value);
+    void clear() { samples = 0; }
+
+    int sampleCount() const { return samples; }
+    const char *data() const { return buffer; }
+    int size() const { return HeaderSize + samples * SampleSize; }
+
+private:
+    char buffer[MaxDatagramSize];
+    qint64 baseNs;
+    int samples;
+};
+
+// Parses a datagram written by TelemetryPacketWriter
+bool decodeTelemetryPacket(const char *data, int size, TelemetryPacket &packet);
+
+#endif // TELEMETRYPACKET_H
@@ -0,0 +1,119 @@
+#include "telemetrypublisher.h"
+#include "monotonicclock.h"
+#include <QDateTime>
+#include <QDebug>
+
+bool parseTelemetryDestination(const QString &text, TelemetrySettings &settings, QString *error) {
+    const int colon = text.lastIndexOf(':');
+    bool ok = false;
+    const quint16 port = colon < 0 ? 0 : text.mid(colon + 1).trimmed().toUShort(&ok);
+    if (!ok || port == 0) {
+        if (error)
+            *error = "expected address:port";
+        return false;
+    }
+
+    QString host = text.left(colon).trimmed();
+    if (host.startsWith('[') && host.endsWith(']'))
+        host = host.mid(1, host.size() - 2);
+    // Numeric addresses only: a name lookup would block the caller
+    QHostAddress address(host);
+    if (host.compare("localhost", Qt::CaseInsensitive) == 0)
+        address = QHostAddress(QHostAddress::LocalHost);
+    if (address.isNull()) {
+        if (error)
+            *error = QString("%1 is not an IP address").arg(host);
+        return false;
+    }
+    settings.address = address;
+    settings.port = port;
+    return true;
+}
+
+TelemetryPublisher::TelemetryPublisher(int sources, QObject *parent)
+    : QObject(parent), sourceCount(sources), socket(new QUdpSocket(this)),
+      drainTimer(new QTimer(this)), utcOffsetUs(0), batchStartNs(0), sequence(0), sent(0), failed(0) {
+    settings.port = 0;
+    settings.intervalMs = 20;
+    settings.ttl = 1;
+    drainTimer->setInterval(DrainIntervalMs);
+    connect(drainTimer, &QTimer::timeout, this, &TelemetryPublisher::drain);
+}
+
+bool TelemetryPublisher::start(const TelemetrySettings &publishSettings) {
+    stop();
+    if (!queues)
+        queues.reset(new TelemetryFrameQueue[sourceCount]);
+
+    // Frames queued while stopped belong to no run
+    DecodedFrame frame;
+    for (int source = 0; source < sourceCount; ++source) {
+        while (queues[source].pop(frame)) {
+        }
+    }
+
+    settings = publishSettings;
+    settings.intervalMs = qMax(1, settings.intervalMs);
+    const bool ipv6 = settings.address.protocol() == QAbstractSocket::IPv6Protocol;
+    socket->close();
+    if (!socket->bind(ipv6 ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4, 0)) {
+        error = socket->errorString();
+        qWarning() << "Cannot open telemetry socket" << error;
+        return false;
+    }
+    if (settings.address.isMulticast()) {
+        // Loopback keeps receivers on the same host working
+        socket->setSocketOption(QAbstractSocket::MulticastTtlOption, settings.ttl);
+        socket->setSocketOption(QAbstractSocket::MulticastLoopbackOption, 1);
+    }
+
+    utcOffsetUs = QDateTime::currentMSecsSinceEpoch() * 1000 - monotonicNanoseconds() / 1000;
+    sequence = 0;
+    packet.clear();
+    error.clear();
+    drainTimer->start();
+    return true;
+}
+
+void TelemetryPublisher::stop() {
+    if (!drainTimer->isActive())
+        return;
+    drainTimer->stop();
+    drain();
+    if (packet.sampleCount() > 0)
+        send();
+    socket->close();
+}
+
+void TelemetryPublisher::drain() {
+    DecodedFrame frame;
+    for (int source = 0; source < sourceCount; ++source) {
+        while (queues[source].pop(frame)) {
+            for (int i = 0; i < frame.sensorCount; ++i) {
+                const SensorSample &sample = frame.samples[i];
+                if (packet.sampleCount() == 0) {
+                    batchStartNs = frame.arrivalNs;
+                    packet.begin(sequence, frame.arrivalNs, frame.arrivalNs / 1000 + utcOffsetUs);
+                }
+                if (!packet.add(frame.arrivalNs, frame.source, sample.id, sample.value)) {
+                    send();
+                    batchStartNs = frame.arrivalNs;
+                    packet.begin(sequence, frame.arrivalNs, frame.arrivalNs / 1000 + utcOffsetUs);
+                    packet.add(frame.arrivalNs, frame.source, sample.id, sample.value);
+                }
+            }
+        }
+    }
+
+    if (packet.sampleCount() > 0 && monotonicNanoseconds() - batchStartNs >= qint64(settings.intervalMs) * 1000000)
+        send();
+}
+
+void TelemetryPublisher::send() {
+    if (socket->writeDatagram(packet.data(), packet.size(), settings.address, settings.port) == packet.size())
+        sent.fetch_add(1, std::memory_order_relaxed);
+    else
+        failed.fetch_add(1, std::memory_order_relaxed);
+    ++sequence;
+    packet.clear();
+}
@@ -0,0 +1,73 @@
+#ifndef TELEMETRYPUBLISHER_H
+#define TELEMETRYPUBLISHER_H
+
+#include <QHostAddress>
+#include <QObject>
+#include <QTimer>
+#include <QUdpSocket>
+#include <atomic>
+#include <memory>
+#include "framedecoder.h"
+#include "spscqueue.h"
+#include "telemetrypacket.h"
+
+typedef SpscQueue<DecodedFrame, 256> TelemetryFrameQueue;
+
+struct TelemetrySettings {
+    QHostAddress address; // unicast or multicast group
+    quint16 port;
+    int intervalMs;       // longest time a sample waits for its datagram
+    int ttl;              // multicast hops
+};
+
+// Parses "address:port"; address is a numeric IPv4/IPv6 address (IPv6 may
+// be bracketed), a multicast group or localhost. Names are not resolved, so
+// parsing never blocks on DNS.
+bool parseTelemetryDestination(const QString &text, TelemetrySettings &settings, QString *error = nullptr);
+
+// Publishes decoded samples as UDP datagrams on its own thread. Each
+// acquisition source pushes its frames into its own queue(); samples are
+// packed into datagrams (see telemetrypacket.h) that go out when full or
+// when the oldest sample has waited the batch interval, so the packet rate
+// stays low at any frame rate.
+class TelemetryPublisher : public QObject {
+    Q_OBJECT
+public:
+    explicit TelemetryPublisher(int sources, QObject *parent = nullptr);
+
+    // Allocated by the first start() and kept, since workers may still
+    // hold them after stop()
+    TelemetryFrameQueue &queue(int source) { return queues[source]; }
+
+    // Must be called on the publisher's thread
+    bool start(const TelemetrySettings &settings);
+    void stop();
+    bool isPublishing() const { return drainTimer->isActive(); }
+    QString errorString() const { return error; }
+
+    quint64 sentDatagrams() const { return sent.load(std::memory_order_relaxed); }
+    quint64 failedDatagrams() const { return failed.load(std::memory_order_relaxed); }
+
+private slots:
+    void drain();
+
+private:
+    static const int DrainIntervalMs = 5;
+
+    void send();
+
+    std::unique_ptr<TelemetryFrameQueue[]> queues;
+    int sourceCount;
+    QUdpSocket *socket;
+    QTimer *drainTimer;
+    TelemetrySettings settings;
+    TelemetryPacketWriter packet;
+    qint64 utcOffsetUs; // wall clock minus monotonic clock
+    qint64 batchStartNs;
+    quint32 sequence;
+    std::atomic<quint64> sent;
+    std::atomic<quint64> failed;
+    QString error;
+};
+
+#endif // TELEMETRYPUBLISHER_H
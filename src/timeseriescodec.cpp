@@ -0,0 +1,180 @@
+#include "timeseriescodec.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+static quint64 doubleBits(double value) {
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static qint64 signExtend(quint64 value, int bits) {
+    return qint64(value << (64 - bits)) >> (64 - bits);
+}
+
+TimeSeriesEncoder::TimeSeriesEncoder() {
+    clear();
+}
+
+void TimeSeriesEncoder::clear() {
+    bytes.resize(0);
+    accumulator = 0;
+    accumulated = 0;
+    samples = 0;
+    startNs = 0;
+    previousTicks = 0;
+    previousDelta = 0;
+    previousBits = 0;
+    previousLeading = -1;
+    previousTrailing = 0;
+    minValue = 0;
+    maxValue = 0;
+}
+
+void TimeSeriesEncoder::writeBits(quint64 value, int count) {
+    if (count > 32) {
+        writeBits(value >> 32, count - 32);
+        count = 32;
+    }
+    accumulator = (accumulator << count) | (value & ((quint64(1) << count) - 1));
+    accumulated += count;
+    while (accumulated >= 8) {
+        accumulated -= 8;
+        bytes.append(char(accumulator >> accumulated));
+    }
+    accumulator &= (quint64(1) << accumulated) - 1;
+}
+
+void TimeSeriesEncoder::append(qint64 timeNs, double value) {
+    const quint64 bits = doubleBits(value);
+    if (samples == 0) {
+        startNs = timeNs;
+        minValue = maxValue = value;
+        writeBits(bits, 64);
+        previousBits = bits;
+        ++samples;
+        return;
+    }
+
+    const qint64 ticks = (timeNs - startNs) / TickNs;
+    const qint64 delta = ticks - previousTicks;
+    const qint64 deltaOfDelta = delta - previousDelta;
+    if (deltaOfDelta == 0) {
+        writeBits(0, 1);
+    } else if (deltaOfDelta >= -64 && deltaOfDelta <= 63) {
+        writeBits(0x2, 2);
+        writeBits(quint64(deltaOfDelta), 7);
+    } else if (deltaOfDelta >= -256 && deltaOfDelta <= 255) {
+        writeBits(0x6, 3);
+        writeBits(quint64(deltaOfDelta), 9);
+    } else if (deltaOfDelta >= -2048 && deltaOfDelta <= 2047) {
+        writeBits(0xE, 4);
+        writeBits(quint64(deltaOfDelta), 12);
+    } else {
+        writeBits(0xF, 4);
+        writeBits(quint64(deltaOfDelta), 64);
+    }
+    previousTicks = ticks;
+    previousDelta = delta;
+
+    const quint64 difference = bits ^ previousBits;
+    if (difference == 0) {
+        writeBits(0, 1);
+    } else {
+        const int leading = qMin(int(qCountLeadingZeroBits(difference)), 31);
+        const int trailing = int(qCountTrailingZeroBits(difference));
+        if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing) {
+            writeBits(0x2, 2);
+            writeBits(difference >> previousTrailing, 64 - previousLeading - previousTrailing);
+        } else {
+            const int significant = 64 - leading - trailing;
+            writeBits(0x3, 2);
+            writeBits(quint64(leading), 5);
+            writeBits(quint64(significant - 1), 6);
+            writeBits(difference >> trailing, significant);
+            previousLeading = leading;
+            previousTrailing = trailing;
+        }
+    }
+    previousBits = bits;
+    minValue = qMin(minValue, value);
+    maxValue = qMax(maxValue, value);
+    ++samples;
+}
+
+const QByteArray &TimeSeriesEncoder::finish() {
+    if (accumulated > 0) {
+        bytes.append(char(accumulator << (8 - accumulated)));
+        accumulator = 0;
+        accumulated = 0;
+    }
+    return bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+
+TimeSeriesDecoder::TimeSeriesDecoder(const uchar *bytes, int size, int sampleCount, qint64 firstNs)
+    : data(bytes), bitCount(qint64(size) * 8), position(0), remaining(sampleCount), decoded(0), startNs(firstNs),
+      previousTicks(0), previousDelta(0), previousBits(0), previousLeading(0), previousTrailing(0), overrun(false) {
+}
+
+quint64 TimeSeriesDecoder::readBits(int count) {
+    if (position + count > bitCount) {
+        overrun = true;
+        return 0;
+    }
+    quint64 result = 0;
+    while (count > 0) {
+        const int offset = int(position & 7);
+        const int available = 8 - offset;
+        const int take = qMin(available, count);
+        const quint64 bits = (data[position >> 3] >> (available - take)) & ((1u << take) - 1);
+        result = (result << take) | bits;
+        position += take;
+        count -= take;
+    }
+    return result;
+}
+
+bool TimeSeriesDecoder::next(qint64 &timeNs, double &value) {
+    if (remaining == 0 || overrun)
+        return false;
+    if (decoded == 0) {
+        previousBits = readBits(64);
+        timeNs = startNs;
+    } else {
+        qint64 deltaOfDelta = 0;
+        if (readBits(1) != 0) {
+            int bits = 7;
+            if (readBits(1) != 0) {
+                bits = 9;
+                if (readBits(1) != 0)
+                    bits = readBits(1) != 0 ? 64 : 12;
+            }
+            deltaOfDelta = bits == 64 ? qint64(readBits(64)) : signExtend(readBits(bits), bits);
+        }
+        previousDelta += deltaOfDelta;
+        previousTicks += previousDelta;
+        timeNs = startNs + previousTicks * TimeSeriesEncoder::TickNs;
+
+        if (readBits(1) != 0) {
+            if (readBits(1) != 0) {
+                previousLeading = int(readBits(5));
+                const int significant = int(readBits(6)) + 1;
+                previousTrailing = 64 - previousLeading - significant;
+            }
+            // A damaged block can ask for a window that does not exist
+            const int significant = 64 - previousLeading - previousTrailing;
+            if (significant <= 0 || previousTrailing < 0)
+                overrun = true;
+            else
+                previousBits ^= readBits(significant) << previousTrailing;
+        }
+    }
+    if (overrun)
+        return false;
+    memcpy(&value, &previousBits, sizeof(value));
+    --remaining;
+    ++decoded;
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef TIMESERIESCODEC_H
+#define TIMESERIESCODEC_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+// Compression of one sensor's samples, after Gorilla (Pelkonen et al.,
+// VLDB 2015).
+//
+// Timestamps are kept in ticks of TickNs after the block's first sample,
+// which keeps arrival jitter of a few hundred microseconds in the short
+// codes, and stored as delta-of-delta:
+//   0                      '0'
+//   -64 .. 63              '10'   + 7 bits
+//   -256 .. 255            '110'  + 9 bits
+//   -2048 .. 2047          '1110' + 12 bits
+//   otherwise              '1111' + 64 bits
+// (two's complement).
+// Values are IEEE 754 doubles XORed with their predecessor:
+//   same value             '0'
+//   inside previous window '10' + the meaningful bits
+//   otherwise              '11' + 5 bits leading zeros + 6 bits length - 1
+//                               + the meaningful bits
+// The first value is stored in full. Bits are written MSB first.
+
+class TimeSeriesEncoder {
+public:
+    static const qint64 TickNs = 10000;
+    // Worst case per sample: 4 + 64 bits of time, 2 + 5 + 6 + 64 bits of value
+    static const int MaxBitsPerSample = 145;
+
+    TimeSeriesEncoder();
+
+    // Starts an empty block; the capacity of data() is kept
+    void clear();
+    void append(qint64 timeNs, double value);
+
+    int sampleCount() const { return samples; }
+    qint64 firstNs() const { return startNs; }
+    qint64 lastNs() const { return startNs + previousTicks * TickNs; }
+    double minimum() const { return minValue; }
+    double maximum() const { return maxValue; }
+
+    // Completes the last byte; append() may not be called afterwards
+    const QByteArray &finish();
+
+private:
+    void writeBits(quint64 value, int count);
+
+    QByteArray bytes;
+    quint64 accumulator;
+    int accumulated;
+    int samples;
+    qint64 startNs;
+    qint64 previousTicks;
+    qint64 previousDelta;
+    quint64 previousBits;
+    int previousLeading;
+    int previousTrailing;
+    double minValue;
+    double maxValue;
+};
+
+class TimeSeriesDecoder {
+public:
+    TimeSeriesDecoder(const uchar *data, int size, int sampleCount, qint64 firstNs);
+
+    // False at the end of the block or when the data is cut short or damaged
+    bool next(qint64 &timeNs, double &value);
+
+private:
+    quint64 readBits(int count);
+
+    const uchar *data;
+    qint64 bitCount;
+    qint64 position;
+    int remaining;
+    int decoded;
+    qint64 startNs;
+    qint64 previousTicks;
+    qint64 previousDelta;
+    quint64 previousBits;
+    int previousLeading;
+    int previousTrailing;
+    bool overrun;
+};
+
+#endif // TIMESERIESCODEC_H
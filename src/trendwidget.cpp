@@ -0,0 +1,206 @@
+#include "trendwidget.h"
+#include <QPainter>
+#include <QWheelEvent>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+static const qint64 Second = 1000000000LL;
+static const qint64 Spans[] = {
+    10 * Second, 30 * Second, 60 * Second, 5 * 60 * Second, 10 * 60 * Second,
+    30 * 60 * Second, 3600 * Second, 2 * 3600 * Second, 4 * 3600 * Second, 8 * 3600 * Second,
+};
+static const int SpanCount = int(sizeof(Spans) / sizeof(Spans[0]));
+static const int LegendHeight = 20;
+
+static QString spanText(qint64 spanNs) {
+    const qint64 seconds = spanNs / Second;
+    if (seconds < 60)
+        return QString("%1 s").arg(seconds);
+    if (seconds < 3600)
+        return QString("%1 min").arg(seconds / 60);
+    return QString("%1 h").arg(seconds / 3600);
+}
+
+TrendWidget::TrendWidget(QWidget *parent)
+    : QWidget(parent), history(nullptr), spanNs(10 * 60 * Second), columnNs(1), lastColumn(-1), level(SensorHistory::Raw) {
+    setMinimumSize(200, 120);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void TrendWidget::setHistory(const SensorHistory *source) {
+    history = source;
+    lastColumn = -1;
+}
+
+void TrendWidget::addChannel(quint8 id, const QString &name, float minValue, float maxValue, const QColor &color) {
+    channels.append({ id, name, minValue, maxValue, color });
+    lastColumn = -1;
+}
+
+void TrendWidget::setSpan(qint64 span) {
+    spanNs = span;
+    lastColumn = -1;
+}
+
+QRect TrendWidget::plotRect() const {
+    return QRect(0, LegendHeight, width(), qMax(1, height() - LegendHeight));
+}
+
+void TrendWidget::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    lastColumn = -1;
+}
+
+void TrendWidget::wheelEvent(QWheelEvent *event) {
+    int index = 0;
+    while (index < SpanCount - 1 && Spans[index] < spanNs)
+        ++index;
+    index += event->angleDelta().y() > 0 ? -1 : 1;
+    setSpan(Spans[qBound(0, index, SpanCount - 1)]);
+    event->accept();
+}
+
+void TrendWidget::advance(qint64 nowNs) {
+    if (!history || channels.isEmpty())
+        return;
+
+    const QRect rect = plotRect();
+    const int columns = rect.width();
+    const SensorHistory::Level wanted = levelAt(nowNs, columns);
+    if (lastColumn < 0 || plot.size() != rect.size() || wanted != level) {
+        // Layout, span, channels or resolution changed: start over
+        if (plot.size() != rect.size())
+            plot = QImage(rect.size(), QImage::Format_RGB32);
+        columnNs = qMax<qint64>(1, spanNs / columns);
+        level = wanted;
+        meanY.fill(std::numeric_limits<float>::quiet_NaN(), channels.size() * columns);
+        lastColumn = nowNs / columnNs;
+        drawColumns(0, columns);
+        update();
+        return;
+    }
+
+    const qint64 column = nowNs / columnNs;
+    const qint64 elapsed = column - lastColumn;
+    if (elapsed >= columns) {
+        lastColumn = -1;
+        advance(nowNs);
+        return;
+    }
+
+    // The right-most column was still filling, so it is drawn again
+    if (elapsed > 0)
+        scrollColumns(int(elapsed));
+    lastColumn = column;
+    drawColumns(columns - 1 - int(elapsed), int(elapsed) + 1);
+    update(plotRect());
+}
+
+SensorHistory::Level TrendWidget::levelAt(qint64 nowNs, int columns) const {
+    // Only the part of the span that has data counts, so a short run is
+    // drawn from raw samples instead of the coarsest tier
+    const quint8 reference = channels.first().id;
+    const qint64 firstNs = history->firstTime(reference, SensorHistory::Raw);
+    const qint64 fromNs = qMax(nowNs - spanNs, firstNs);
+    return history->levelFor(reference, fromNs, nowNs, columns);
+}
+
+void TrendWidget::scrollColumns(int count) {
+    const int columns = plot.width();
+    const int keep = columns - count;
+    for (int y = 0; y < plot.height(); ++y) {
+        uchar *line = plot.scanLine(y);
+        memmove(line, line + count * 4, size_t(keep) * 4);
+    }
+    for (int c = 0; c < channels.size(); ++c) {
+        float *row = meanY.data() + c * columns;
+        memmove(row, row + count, size_t(keep) * sizeof(float));
+        std::fill(row + keep, row + columns, std::numeric_limits<float>::quiet_NaN());
+    }
+}
+
+void TrendWidget::drawColumns(int firstX, int count) {
+    const int columns = plot.width();
+    const int plotHeight = plot.height();
+    const qint64 firstColumn = lastColumn - (columns - 1) + firstX;
+    const qint64 fromNs = firstColumn * columnNs;
+    const qint64 toNs = (firstColumn + count) * columnNs;
+    const qint64 period = SensorHistory::periodNs(level);
+
+    QPainter painter(&plot);
+    painter.fillRect(firstX, 0, count, plotHeight, QColor(20, 20, 24));
+    painter.setPen(QColor(60, 60, 68));
+    for (int quarter = 1; quarter < 4; ++quarter) {
+        const int y = plotHeight * quarter / 4;
+        painter.drawLine(firstX, y, firstX + count - 1, y);
+    }
+
+    for (int c = 0; c < channels.size(); ++c) {
+        const Channel &channel = channels[c];
+        columnMin.fill(std::numeric_limits<float>::max(), count);
+        columnMax.fill(std::numeric_limits<float>::lowest(), count);
+
+        // Bin the points of the slice into the columns they cover
+        points.resize(0);
+        history->read(channel.id, level, fromNs, toNs, points);
+        for (const SensorHistory::Point &point : points) {
+            const qint64 first = qMax<qint64>(0, point.timeNs / columnNs - firstColumn);
+            const qint64 last = qMin<qint64>(count - 1, (point.timeNs + qMax<qint64>(period, 1) - 1) / columnNs - firstColumn);
+            for (qint64 x = first; x <= last; ++x) {
+                columnMin[int(x)] = qMin(columnMin[int(x)], point.minValue);
+                columnMax[int(x)] = qMax(columnMax[int(x)], point.maxValue);
+            }
+        }
+
+        const float range = channel.maxValue > channel.minValue ? channel.maxValue - channel.minValue : 1;
+        const float scale = (plotHeight - 1) / range;
+        float *row = meanY.data() + c * columns;
+        painter.setPen(channel.color);
+        for (int i = 0; i < count; ++i) {
+            const int x = firstX + i;
+            if (columnMin[i] > columnMax[i]) {
+                row[x] = std::numeric_limits<float>::quiet_NaN();
+                continue;
+            }
+            float top = (plotHeight - 1) - (columnMax[i] - channel.minValue) * scale;
+            float bottom = (plotHeight - 1) - (columnMin[i] - channel.minValue) * scale;
+            row[x] = (top + bottom) / 2;
+
+            // Join up with the previous column so a steep edge stays connected
+            if (x > 0 && !std::isnan(row[x - 1])) {
+                top = qMin(top, row[x - 1]);
+                bottom = qMax(bottom, row[x - 1]);
+            }
+            const int y1 = qBound(0, int(top), plotHeight - 1);
+            const int y2 = qBound(0, int(bottom), plotHeight - 1);
+            painter.drawLine(x, y1, x, y2);
+        }
+    }
+}
+
+void TrendWidget::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    const QRect rect = plotRect();
+    painter.fillRect(0, 0, width(), LegendHeight, palette().window());
+    if (plot.isNull())
+        painter.fillRect(rect, QColor(20, 20, 24));
+    else
+        painter.drawImage(rect.topLeft(), plot);
+
+    // Legend and scale on top of the plot
+    int x = 4;
+    const int baseline = LegendHeight - 5;
+    painter.setPen(palette().windowText().color());
+    const QString resolution = level == SensorHistory::Raw ? QString("raw") : spanText(SensorHistory::periodNs(level)) + " rollup";
+    const QString scale = QString("Last %1 (%2), % of range").arg(spanText(spanNs), resolution);
+    painter.drawText(x, baseline, scale);
+    x += painter.fontMetrics().horizontalAdvance(scale) + 16;
+    for (const Channel &channel : channels) {
+        if (x > width())
+            break;
+        painter.fillRect(x, baseline - 8, 8, 8, channel.color);
+        painter.drawText(x + 11, baseline, channel.name);
+        x += 11 + painter.fontMetrics().horizontalAdvance(channel.name) + 10;
+    }
+}
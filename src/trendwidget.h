@@ -0,0 +1,64 @@
+#ifndef TRENDWIDGET_H
+#define TRENDWIDGET_H
+
+#include <QColor>
+#include <QImage>
+#include <QVector>
+#include <QWidget>
+#include "sensorhistory.h"
+
+// Scrolling multi-channel trend over a SensorHistory.
+//
+// Every pixel column shows the min/max envelope of each channel over the
+// column's time slice, read from the finest rollup with no more points than
+// columns. The plot is kept in an image: advance() shifts it left by the
+// columns that elapsed and draws only those, so the cost per tick does not
+// depend on the visible span. Values are drawn as a percentage of each
+// sensor's range. The mouse wheel zooms.
+class TrendWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit TrendWidget(QWidget *parent = nullptr);
+
+    void setHistory(const SensorHistory *history);
+    void addChannel(quint8 id, const QString &name, float minValue, float maxValue, const QColor &color);
+
+    void setSpan(qint64 spanNs);
+    qint64 span() const { return spanNs; }
+
+    // Brings the plot up to nowNs (monotonic); call once per render tick
+    void advance(qint64 nowNs);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private:
+    struct Channel {
+        quint8 id;
+        QString name;
+        float minValue;
+        float maxValue;
+        QColor color;
+    };
+
+    QRect plotRect() const;
+    SensorHistory::Level levelAt(qint64 nowNs, int columns) const;
+    void drawColumns(int firstX, int count);
+    void scrollColumns(int columns);
+
+    const SensorHistory *history;
+    QVector<Channel> channels;
+    qint64 spanNs;
+    qint64 columnNs;
+    qint64 lastColumn;  // absolute index (time / columnNs) of the image's right edge, -1 when stale
+    SensorHistory::Level level;
+    QImage plot;
+    QVector<float> meanY; // per channel and image column, NaN without data
+    QVector<float> columnMin;
+    QVector<float> columnMax;
+    QVector<SensorHistory::Point> points;
+};
+
+#endif // TRENDWIDGET_H